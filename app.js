@@ -1,4 +1,5 @@
-const API = 'http://127.0.0.1:8080';
+const API    = 'http://127.0.0.1:8080';
+const WS_API = API.replace(/^http/, 'ws');
 
 let currentView   = 'grid';
 let allResults    = [];
@@ -107,13 +108,22 @@ const WEAR_MAP = {
     'Battle-Scarred': { key: 'bs', label: 'BS' },
 };
 
-function getWear(name) {
-    for (const wear of Object.keys(WEAR_MAP)) {
-        if (name.includes(wear)) return wear;
+const WEAR_LABELS = Object.fromEntries(Object.values(WEAR_MAP).map(w => [w.key, w.label]));
+
+// Wear key ("ft") of a skin. The server sends it parsed; demo skins only
+// have the name.
+function getWear(skin) {
+    if (skin.wear !== undefined) return skin.wear;
+    for (const [wear, info] of Object.entries(WEAR_MAP)) {
+        if (skin.name.includes(wear)) return info.key;
     }
     return '';
 }
 
+function isStatTrak(skin) {
+    return skin.stattrak !== undefined ? skin.stattrak : skin.name.includes('StatTrak');
+}
+
 function getBaseName(name) {
     return name
         .replace(/\s*\(Factory New\)|\s*\(Minimal Wear\)|\s*\(Field-Tested\)|\s*\(Well-Worn\)|\s*\(Battle-Scarred\)/g, '')
@@ -121,13 +131,12 @@ function getBaseName(name) {
 }
 
 function wearBadgeHTML(wear) {
-    const info = WEAR_MAP[wear];
-    if (!info) return '';
-    return `<span class="skin-wear-badge wear-${info.key}">${info.label}</span>`;
+    const label = WEAR_LABELS[wear];
+    if (!label) return '';
+    return `<span class="skin-wear-badge wear-${wear}">${label}</span>`;
 }
 
-function skinCardHTML(name, priceText, listings, isStatTrak = false, iconUrl = '', marketUrl = '') {
-    const wear     = getWear(name);
+function skinCardHTML(name, priceText, listings, statTrak = false, iconUrl = '', marketUrl = '', wear = '') {
     const baseName = escapeHTML(getBaseName(name));
     const safePrice = escapeHTML(priceText);
     const safeUrl  = marketUrl && marketUrl.startsWith('https://') ? marketUrl : '#';
@@ -135,7 +144,7 @@ function skinCardHTML(name, priceText, listings, isStatTrak = false, iconUrl = '
         <div class="skin-card">
             <a href="${safeUrl}" target="_blank" rel="noopener noreferrer" class="skin-link">
                 <div class="skin-img-wrap">
-                    ${isStatTrak ? `<div class="st-badge">StatTrak\u2122</div>` : ''}
+                    ${statTrak ? `<div class="st-badge">StatTrak\u2122</div>` : ''}
                     ${iconUrl
                         ? `<img src="${escapeHTML(iconUrl)}" alt="${baseName}" loading="lazy" />`
                         : `<div class="skin-img-placeholder">\u25C8</div>`}
@@ -162,17 +171,15 @@ function renderResults(results, containerId) {
         div.innerHTML = '<div class="msg-error">No skins found.</div>';
         return;
     }
-    div.innerHTML = results.map(skin => {
-        const isStatTrak = skin.name.includes('StatTrak');
-        return skinCardHTML(
-            skin.name,
-            skin.sell_price_text || skin.price,
-            skin.sell_listings   || skin.listings,
-            isStatTrak,
-            skin.icon_url,
-            skin.market_url
-        );
-    }).join('');
+    div.innerHTML = results.map(skin => skinCardHTML(
+        skin.name,
+        skin.sell_price_text || skin.price,
+        skin.sell_listings   || skin.listings,
+        isStatTrak(skin),
+        skin.icon_url,
+        skin.market_url,
+        getWear(skin)
+    )).join('');
 }
 
 // ─── Market Search ─────────────────────────────────────────
@@ -184,6 +191,59 @@ function clearFilters() {
     document.getElementById('stattrakOnly').checked = false;
 }
 
+// Wear keys and StatTrak toggle from the filter panel. The server applies
+// them; only demo data is filtered here.
+function attributeFilters() {
+    return {
+        wears:        [...document.querySelectorAll('.wear-chip input:checked')].map(c => WEAR_MAP[c.value].key),
+        stattrakOnly: document.getElementById('stattrakOnly').checked,
+    };
+}
+
+function filterResults(results) {
+    if (!demoMode) return results;
+    const { wears, stattrakOnly } = attributeFilters();
+    let filtered = results;
+    if (wears.length > 0)
+        filtered = filtered.filter(s => wears.includes(getWear(s)));
+    if (stattrakOnly)
+        filtered = filtered.filter(isStatTrak);
+    return filtered;
+}
+
+function showSearchResults(results) {
+    const filtered = filterResults(results);
+    document.getElementById('resultsCount').textContent =
+        `${filtered.length} listing${filtered.length !== 1 ? 's' : ''}`;
+    renderResults(filtered, 'searchResults');
+}
+
+// Streams results over /search/stream, calling onSkins with each page's new
+// skins as the server parses them. Resolves with the summary record; rejects
+// if the socket fails or closes early so the caller can fall back.
+function streamSearch(q, minPrice, maxPrice, filters, onSkins) {
+    return new Promise((resolve, reject) => {
+        const ws = new WebSocket(`${WS_API}/search/stream`);
+        const msg = { q, min: Number(minPrice), max: Number(maxPrice), wear: filters.wears.join(',') };
+        if (filters.stattrakOnly) msg.stattrak = true;
+        ws.onopen = () => ws.send(JSON.stringify(msg));
+        ws.onmessage = ev => {
+            const msg = JSON.parse(ev.data);
+            if (msg.type === 'skins') {
+                onSkins(msg.results);
+            } else if (msg.type === 'summary') {
+                resolve(msg);
+                ws.close();
+            } else if (msg.type === 'error') {
+                reject(new Error(msg.error));
+                ws.close();
+            }
+        };
+        ws.onerror = () => reject(new Error('Search stream unavailable'));
+        ws.onclose = () => reject(new Error('Search stream closed'));
+    });
+}
+
 async function searchSkins() {
     const q        = document.getElementById('weaponSelect').value;
     const minPrice = document.getElementById('minPrice').value || 0;
@@ -199,8 +259,29 @@ async function searchSkins() {
     resultsDiv.innerHTML = '<div class="msg-loading">Fetching market data\u2026</div>';
     countDiv.textContent = '';
 
+    const filters = attributeFilters();
+
+    // Preferred path: render each page as soon as the server has it
+    if (!demoMode) {
+        allResults = [];
+        try {
+            await streamSearch(q, minPrice, maxPrice, filters, batch => {
+                allResults.push(...batch);
+                showSearchResults(allResults);
+            });
+            if (allResults.length === 0)
+                resultsDiv.innerHTML = '<div class="msg-error">No skins found in that price range.</div>';
+            return;
+        } catch (e) {
+            if (allResults.length > 0) return;  // keep what already streamed in
+        }
+    }
+
     try {
-        const res  = await fetch(`${API}/search?q=${encodeURIComponent(q)}&min=${minPrice}&max=${maxPrice}`);
+        let url = `${API}/search?q=${encodeURIComponent(q)}&min=${minPrice}&max=${maxPrice}`;
+        if (filters.wears.length > 0) url += `&wear=${filters.wears.join(',')}`;
+        if (filters.stattrakOnly)     url += '&stattrak=1';
+        const res  = await fetch(url);
         const data = await res.json();
 
         if (!data.results || data.results.length === 0) {
@@ -209,20 +290,7 @@ async function searchSkins() {
         }
 
         allResults = data.results;
-
-        const checkedWears = [...document.querySelectorAll('.wear-chip input:checked')].map(c => c.value);
-        const stattrakOnly = document.getElementById('stattrakOnly').checked;
-        let filtered = allResults;
-
-        if (checkedWears.length > 0) {
-            filtered = filtered.filter(s => checkedWears.includes(getWear(s.name)));
-        }
-        if (stattrakOnly) {
-            filtered = filtered.filter(s => s.name.includes('StatTrak'));
-        }
-
-        countDiv.textContent = `${filtered.length} listing${filtered.length !== 1 ? 's' : ''}`;
-        renderResults(filtered, 'searchResults');
+        showSearchResults(allResults);
 
     } catch (e) {
         if (!demoMode) {
@@ -232,17 +300,7 @@ async function searchSkins() {
         // Fall back to demo data
         const weapon = q || 'AK-47';
         allResults = getDemoSkins(weapon);
-
-        const checkedWears = [...document.querySelectorAll('.wear-chip input:checked')].map(c => c.value);
-        const stattrakOnly = document.getElementById('stattrakOnly').checked;
-        let filtered = allResults;
-        if (checkedWears.length > 0)
-            filtered = filtered.filter(s => checkedWears.includes(getWear(s.name)));
-        if (stattrakOnly)
-            filtered = filtered.filter(s => s.name.includes('StatTrak'));
-
-        countDiv.textContent = `${filtered.length} listing${filtered.length !== 1 ? 's' : ''}`;
-        renderResults(filtered, 'searchResults');
+        showSearchResults(allResults);
     }
 }
 
@@ -358,10 +416,9 @@ function updateLoadoutTotal() {
 
 function slotSectionHTML(slotKey, slotLabel, slotIcon, budgetLabel, skins) {
     const iconClass = slotKey;
-    const optionsHTML = skins.map(skin => {
-        const isStatTrak = skin.name.includes('StatTrak');
-        return skinCardHTML(skin.name, skin.price, skin.listings, isStatTrak, skin.icon_url, skin.market_url);
-    }).join('');
+    const optionsHTML = skins.map(skin =>
+        skinCardHTML(skin.name, skin.price, skin.listings, isStatTrak(skin), skin.icon_url, skin.market_url, getWear(skin))
+    ).join('');
 
     return `
         <div class="slot-section">
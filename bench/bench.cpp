@@ -0,0 +1,498 @@
+#include "handlers.h"
+#include "subset_sum.h"
+#include "loadout.h"
+#include "log.h"
+#include "market_fetch.h"
+#include "response_cache.h"
+#include "responses.h"
+#include "steam_parser.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ─── Benchmarks ────────────────────────────────────────────
+//
+// Parameterized benchmarks for the hot paths, one JSON object per case on
+// stdout so runs can be diffed between releases:
+//
+//   knapsack  a one-off SubsetSumTable solve over $1..$10,000 budgets and
+//             10..2,000 items, and building / querying a $10,000 table
+//   loadout   optimizeLoadouts() on four slots, and its top k checked against
+//             brute force on small random inputs (aborts on a mismatch)
+//   parse     streaming vs DOM parse of the Steam fixtures in bench/fixtures
+//   serialize skinToJson() + dump, and the response cache's gzip pass
+//   handler   the route handlers end to end, with Steam replaced by a stub
+//             that serves the fixtures (cold = every page parsed and cached,
+//             warm = served from the market and response caches)
+//
+//   cs-skin-bench [--filter=substr] [--min-time-ms=200] [--format=jsonl|csv]
+//                 [--stub-latency-ms=0] [--verbose]
+//
+// Times are per operation in nanoseconds; allocs_per_op counts operator new
+// calls. Server logging is discarded unless --verbose is given.
+
+static std::atomic<long long> allocations{0};
+
+static void* allocate(std::size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+// Array forms too, so every new/delete pair the benchmarks use goes
+// through malloc/free
+void* operator new(std::size_t n) { return allocate(n); }
+void* operator new[](std::size_t n) { return allocate(n); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+struct Options {
+    std::string filter;
+    std::string format      = "jsonl";
+    double      minTimeMs   = 200.0;
+    int         stubLatency = 0;
+    bool        verbose     = false;
+};
+
+struct Case {
+    std::string                                      suite;
+    std::string                                      name;
+    std::vector<std::pair<std::string, long long>>   params;
+    std::function<void()>                            op;
+};
+
+struct Result {
+    long long iterations;
+    double    meanNs;
+    double    p50Ns;
+    double    p99Ns;
+    double    minNs;
+    double    allocsPerOp;
+};
+
+// Runs `op` once untimed, then times each call until `minTimeMs` has
+// passed (at least 5 calls, at most 1,000,000).
+static Result measure(const std::function<void()>& op, double minTimeMs) {
+    using Clock = std::chrono::steady_clock;
+    op();
+
+    std::vector<double> samples;
+    long long allocsBefore = allocations.load();
+    double    totalNs      = 0.0;
+    while ((totalNs < minTimeMs * 1e6 || samples.size() < 5) && samples.size() < 1000000) {
+        auto began = Clock::now();
+        op();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - began).count();
+        samples.push_back(ns);
+        totalNs += ns;
+    }
+    long long allocs = allocations.load() - allocsBefore;
+
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    };
+    long long n = static_cast<long long>(samples.size());
+    return {n, totalNs / n, pct(0.50), pct(0.99), samples.front(), static_cast<double>(allocs) / n};
+}
+
+static void report(const Options& opt, const Case& c, const Result& r) {
+    std::string params;
+    for (const auto& [key, value] : c.params) {
+        if (opt.format == "csv") {
+            if (!params.empty()) params += ';';
+            params += key + "=" + std::to_string(value);
+        } else {
+            if (!params.empty()) params += ',';
+            params += "\"" + key + "\":" + std::to_string(value);
+        }
+    }
+
+    if (opt.format == "csv") {
+        std::printf("%s,%s,%s,%lld,%.1f,%.1f,%.1f,%.1f,%.2f\n",
+                    c.suite.c_str(), c.name.c_str(), params.c_str(), r.iterations,
+                    r.meanNs, r.p50Ns, r.p99Ns, r.minNs, r.allocsPerOp);
+    } else {
+        std::printf("{\"suite\":\"%s\",\"case\":\"%s\",\"params\":{%s},\"iterations\":%lld,"
+                    "\"mean_ns\":%.1f,\"p50_ns\":%.1f,\"p99_ns\":%.1f,\"min_ns\":%.1f,"
+                    "\"allocs_per_op\":%.2f}\n",
+                    c.suite.c_str(), c.name.c_str(), params.c_str(), r.iterations,
+                    r.meanNs, r.p50Ns, r.p99Ns, r.minNs, r.allocsPerOp);
+    }
+    std::fflush(stdout);
+}
+
+// ─── Fixtures ──────────────────────────────────────────────
+
+struct Fixture {
+    std::string       name;
+    std::string       body;
+    std::vector<Skin> skins;
+};
+
+static std::vector<Fixture> loadFixtures() {
+    std::vector<std::string> paths;
+    for (const auto& e : std::filesystem::directory_iterator(BENCH_FIXTURE_DIR))
+        if (e.path().extension() == ".json") paths.push_back(e.path().string());
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<Fixture> fixtures;
+    for (const auto& path : paths) {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+
+        Fixture f;
+        f.name = std::filesystem::path(path).stem().string();
+        f.body = ss.str();
+
+        auto stream = parseSearchPage(f.body);
+        auto dom    = parseSearchPageDom(f.body);
+        bool same   = stream && dom && std::equal(
+            stream->begin(), stream->end(), dom->begin(), dom->end(), [](const Skin& x, const Skin& y) {
+                return x.name == y.name && x.hash_name == y.hash_name && x.price_text == y.price_text &&
+                       x.sale_price_text == y.sale_price_text && x.icon == y.icon &&
+                       x.price_cents == y.price_cents && x.listings == y.listings;
+            });
+        if (!same) {
+            std::fprintf(stderr, "%s: parsers disagree\n", path.c_str());
+            std::exit(1);
+        }
+        f.skins = std::move(*stream);
+        fixtures.push_back(std::move(f));
+    }
+    if (fixtures.empty()) {
+        std::fprintf(stderr, "no fixtures in %s\n", BENCH_FIXTURE_DIR);
+        std::exit(1);
+    }
+    return fixtures;
+}
+
+// Cycles through every fixture skin until `n` are collected.
+static std::vector<Skin> fixtureSkins(const std::vector<Fixture>& fixtures, size_t n) {
+    std::vector<Skin> all;
+    for (const auto& f : fixtures)
+        all.insert(all.end(), f.skins.begin(), f.skins.end());
+
+    std::vector<Skin> out;
+    for (size_t i = 0; out.size() < n; i++)
+        out.push_back(all[i % all.size()]);
+    return out;
+}
+
+// ─── Suites ────────────────────────────────────────────────
+
+// Log-uniform prices between 3 cents and the budget, which is what a
+// fetchQuery() capped at the budget returns for a broad query.
+static std::vector<Skin> syntheticSkins(int n, int budgetCents, unsigned seed) {
+    std::mt19937                           rng(seed);
+    std::uniform_real_distribution<double> logPrice(std::log(3.0), std::log(std::max(4, budgetCents)));
+
+    std::vector<Skin> skins(n);
+    for (auto& s : skins)
+        s.price_cents = static_cast<int>(std::exp(logPrice(rng)));
+    return skins;
+}
+
+static void knapsackSuite(std::vector<Case>& cases) {
+    for (int budget : {100, 1000, 10000, 100000, 1000000}) {
+        for (int items : {10, 100, 500, 2000}) {
+            auto skins = std::make_shared<std::vector<Skin>>(syntheticSkins(items, budget, 42));
+            cases.push_back({"knapsack", "budget=" + std::to_string(budget) + "/items=" + std::to_string(items),
+                             {{"budget_cents", budget}, {"items", items}},
+                             [skins, budget]() {
+                                 std::vector<int> weights;
+                                 weights.reserve(skins->size());
+                                 for (const auto& s : *skins)
+                                     weights.push_back(s.price_cents);
+                                 SubsetSumTable table(weights, budget);
+                                 if (table.best(budget) > 0 && table.choose(budget).empty()) std::abort();
+                             }});
+        }
+    }
+
+    // A budget slider: one table build, then a lookup per step
+    for (int items : {100, 500, 2000}) {
+        std::vector<int> weights;
+        for (const auto& s : syntheticSkins(items, 1000000, 42))
+            weights.push_back(s.price_cents);
+        auto table = std::make_shared<SubsetSumTable>(weights, 1000000);
+        std::vector<std::pair<std::string, long long>> params = {
+            {"budget_cents", 1000000}, {"items", items},
+        };
+
+        cases.push_back({"knapsack", "table_build/items=" + std::to_string(items), params, [weights]() {
+            if (SubsetSumTable(weights, 1000000).limit() <= 0) std::abort();
+        }});
+        auto budget = std::make_shared<int>(0);
+        cases.push_back({"knapsack", "table_choose/items=" + std::to_string(items), params, [table, budget]() {
+            *budget = (*budget + 7919) % 990000;
+            if (table->choose(10000 + *budget).empty()) std::abort();
+        }});
+    }
+}
+
+// Every complete loadout within `cap`, best first: the reference the
+// optimizer's top k must match value for value.
+static std::vector<long long> bruteForceLoadouts(const std::vector<std::vector<SlotCandidate>>& slots,
+                                                 long long cap) {
+    std::vector<long long> values;
+    auto walk = [&](auto&& self, size_t s, long long price, long long value) -> void {
+        if (price > cap) return;
+        if (s == slots.size()) {
+            values.push_back(value);
+            return;
+        }
+        for (const auto& c : slots[s])
+            if (c.price > 0) self(self, s + 1, price + c.price, value + c.value);
+    };
+    walk(walk, 0, 0, 0);
+    std::sort(values.rbegin(), values.rend());
+    return values;
+}
+
+// Few distinct prices, so slots are full of ties and dominated candidates
+static std::vector<std::vector<SlotCandidate>> randomSlots(std::mt19937& rng, size_t m, int n, bool valueIsPrice) {
+    std::uniform_int_distribution<int> price(1, 12);
+    std::uniform_int_distribution<int> value(0, 15);
+    std::vector<std::vector<SlotCandidate>> slots(m);
+    for (auto& slot : slots)
+        for (int i = 0; i < n; i++) {
+            int p = price(rng);
+            slot.push_back({p, valueIsPrice ? p : value(rng)});
+        }
+    return slots;
+}
+
+static void loadoutSuite(std::vector<Case>& cases) {
+    for (int k : {1, 5, 20}) {
+        auto rng = std::make_shared<std::mt19937>(k);
+        cases.push_back({"loadout", "topk_vs_brute/k=" + std::to_string(k), {{"k", k}}, [rng, k]() {
+            size_t    m   = 1 + (*rng)() % 4;
+            auto      slots = randomSlots(*rng, m, 1 + static_cast<int>((*rng)() % 8), (*rng)() % 2 == 0);
+            long long cap = 1 + (*rng)() % (13 * m);
+
+            std::vector<long long>   expect = bruteForceLoadouts(slots, cap);
+            std::vector<LoadoutPick> got    = optimizeLoadouts(slots, cap, k);
+            if (got.size() != std::min(expect.size(), static_cast<size_t>(k))) std::abort();
+            for (size_t i = 0; i < got.size(); i++) {
+                long long price = 0, value = 0;
+                for (size_t s = 0; s < m; s++) {
+                    price += slots[s][got[i].choice[s]].price;
+                    value += slots[s][got[i].choice[s]].value;
+                }
+                if (price != got[i].price || value != got[i].value || price > cap) std::abort();
+                if (value != expect[i]) std::abort();
+                for (size_t j = 0; j < i; j++)
+                    if (got[j].choice == got[i].choice) std::abort();
+            }
+        }});
+    }
+
+    // Four slots of 300 candidates, value == price as /loadout/build sets it
+    for (int k : {1, 5, 20}) {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> price(100, 200000);
+        auto slots = std::make_shared<std::vector<std::vector<SlotCandidate>>>(4);
+        for (auto& slot : *slots)
+            for (int i = 0; i < 300; i++) {
+                int p = price(rng);
+                slot.push_back({p, p});
+            }
+        cases.push_back({"loadout", "optimize/k=" + std::to_string(k), {{"k", k}, {"candidates", 1200}},
+                         [slots, k]() {
+                             if (optimizeLoadouts(*slots, 200000, k).empty()) std::abort();
+                         }});
+    }
+}
+
+static void parseSuite(std::vector<Case>& cases, const std::vector<Fixture>& fixtures) {
+    for (const auto& f : fixtures) {
+        std::vector<std::pair<std::string, long long>> params = {
+            {"bytes", static_cast<long long>(f.body.size())},
+            {"skins", static_cast<long long>(f.skins.size())},
+        };
+        const std::string* body = &f.body;
+        cases.push_back({"parse", "stream/" + f.name, params, [body]() {
+            if (!parseSearchPage(*body)) std::abort();
+        }});
+        cases.push_back({"parse", "dom/" + f.name, params, [body]() {
+            if (!parseSearchPageDom(*body)) std::abort();
+        }});
+    }
+}
+
+static std::string searchBody(const std::vector<Skin>& skins) {
+    std::vector<crow::json::wvalue> results;
+    results.reserve(skins.size());
+    for (const auto& s : skins)
+        results.push_back(skinToJson(s));
+
+    crow::json::wvalue r;
+    r["total_count"] = static_cast<int>(results.size());
+    r["results"]     = std::move(results);
+    return r.dump();
+}
+
+static void serializeSuite(std::vector<Case>& cases, const std::vector<Fixture>& fixtures) {
+    for (int n : {10, 50, 200}) {
+        auto skins = std::make_shared<std::vector<Skin>>(fixtureSkins(fixtures, n));
+        auto body  = std::make_shared<std::string>(searchBody(*skins));
+        std::vector<std::pair<std::string, long long>> params = {
+            {"skins", n}, {"bytes", static_cast<long long>(body->size())},
+        };
+
+        cases.push_back({"serialize", "search_json/skins=" + std::to_string(n), params, [skins]() {
+            if (searchBody(*skins).empty()) std::abort();
+        }});
+        cases.push_back({"serialize", "gzip_best/skins=" + std::to_string(n), params, [body]() {
+            if (makeBody(*body, Z_BEST_COMPRESSION).etag.empty()) std::abort();
+        }});
+    }
+}
+
+// Answers every page request with a fixture chosen by URL, after an
+// optional delay standing in for Steam's latency.
+static void installStubTransport(const std::vector<Fixture>& fixtures, int latencyMs) {
+    setPageTransport([&fixtures, latencyMs](const std::vector<std::string>& urls, FetchPriority,
+                                            const FetchDone& onDone) {
+        if (latencyMs > 0 && !urls.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+        for (size_t i = 0; i < urls.size(); i++) {
+            const Fixture& f = fixtures[std::hash<std::string>()(urls[i]) % fixtures.size()];
+            onDone(i, FetchResult{200, f.body});
+        }
+    });
+}
+
+static crow::request makeRequest(crow::HTTPMethod method, const std::string& url, std::string body = "") {
+    crow::request req;
+    req.method     = method;
+    req.raw_url    = url;
+    req.url        = url.substr(0, url.find('?'));
+    req.url_params = crow::query_string(url);
+    req.body       = std::move(body);
+    req.add_header("Accept-Encoding", "gzip");
+    return req;
+}
+
+// Runs a deferred handler to completion on the calling thread.
+static crow::response call(void (*handler)(const crow::request&, Respond), const crow::request& req) {
+    std::promise<crow::response> ready;
+    std::future<crow::response>  res = ready.get_future();
+    handler(req, [&ready](crow::response r) { ready.set_value(std::move(r)); });
+    return res.get();
+}
+
+static void handlerSuite(std::vector<Case>& cases) {
+    auto counter = std::make_shared<long long>(0);
+
+    // Cold requests use a query no earlier request has seen, so every page
+    // goes through the stub, the parser, the caches and the index.
+    cases.push_back({"handler", "search/cold", {{"pages", 20}}, [counter]() {
+        auto req = makeRequest(crow::HTTPMethod::Get, "/search?q=cold" + std::to_string(++*counter));
+        if (call(handleSearch, req).code != 200) std::abort();
+    }});
+    cases.push_back({"handler", "search/warm", {{"pages", 20}}, []() {
+        auto req = makeRequest(crow::HTTPMethod::Get, "/search?q=AK-47&min=1&max=500");
+        if (call(handleSearch, req).code != 200) std::abort();
+    }});
+    cases.push_back({"handler", "search/not_modified", {{"pages", 20}}, []() {
+        auto req = makeRequest(crow::HTTPMethod::Get, "/search?q=AK-47&min=1&max=500");
+        req.add_header("If-None-Match", call(handleSearch, req).get_header_value("ETag"));
+        if (call(handleSearch, req).code != 304) std::abort();
+    }});
+    cases.push_back({"handler", "budget/cold", {{"budget_cents", 5000}, {"pages", 20}}, [counter]() {
+        std::string body = "{\"budget\": 50, \"query\": \"cold" + std::to_string(++*counter) + "\"}";
+        auto req = makeRequest(crow::HTTPMethod::Post, "/budget/optimize", body);
+        if (call(handleBudgetOptimize, req).code != 200) std::abort();
+    }});
+    cases.push_back({"handler", "budget/warm", {{"budget_cents", 5000}, {"pages", 20}}, []() {
+        auto req = makeRequest(crow::HTTPMethod::Post, "/budget/optimize",
+                               "{\"budget\": 50, \"query\": \"AK-47\"}");
+        if (call(handleBudgetOptimize, req).code != 200) std::abort();
+    }});
+    cases.push_back({"handler", "loadout_split/warm", {{"budget_cents", 20000}}, []() {
+        auto req = makeRequest(crow::HTTPMethod::Post, "/loadout/build",
+                               "{\"side\": \"T\", \"weapons_budget\": 100, \"knife_budget\": 50,"
+                               " \"gloves_budget\": 50}");
+        if (call(handleLoadoutBuild, req).code != 200) std::abort();
+    }});
+    cases.push_back({"handler", "loadout_total/warm", {{"budget_cents", 20000}, {"top_k", 5}}, []() {
+        auto req = makeRequest(crow::HTTPMethod::Post, "/loadout/build",
+                               "{\"side\": \"CT\", \"mode\": \"total\", \"total_budget\": 200, \"top_k\": 5}");
+        if (call(handleLoadoutBuild, req).code != 200) std::abort();
+    }});
+}
+
+// ─── Main ──────────────────────────────────────────────────
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](const char* flag) -> const char* {
+            size_t n = std::char_traits<char>::length(flag);
+            return arg.compare(0, n, flag) == 0 ? arg.c_str() + n : nullptr;
+        };
+        if (const char* v = value("--filter="))               opt.filter      = v;
+        else if (const char* v = value("--format="))          opt.format      = v;
+        else if (const char* v = value("--min-time-ms="))     opt.minTimeMs   = std::atof(v);
+        else if (const char* v = value("--stub-latency-ms=")) opt.stubLatency = std::atoi(v);
+        else if (arg == "--verbose")                          opt.verbose     = true;
+        else {
+            std::fprintf(stderr, "usage: %s [--filter=substr] [--min-time-ms=200] [--format=jsonl|csv]"
+                                 " [--stub-latency-ms=0] [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (opt.format != "jsonl" && opt.format != "csv") {
+        std::fprintf(stderr, "unknown format: %s\n", opt.format.c_str());
+        return 2;
+    }
+
+    // Keep fetch-path warnings (empty stub pages etc.) out of the results
+    if (!opt.verbose)
+        setLogLevel(LogLevel::Off);
+
+    std::vector<Fixture> fixtures = loadFixtures();
+    installStubTransport(fixtures, opt.stubLatency);
+
+    std::vector<Case> cases;
+    knapsackSuite(cases);
+    loadoutSuite(cases);
+    parseSuite(cases, fixtures);
+    serializeSuite(cases, fixtures);
+    handlerSuite(cases);
+
+    if (opt.format == "csv")
+        std::printf("suite,case,params,iterations,mean_ns,p50_ns,p99_ns,min_ns,allocs_per_op\n");
+
+    for (const auto& c : cases) {
+        if (!opt.filter.empty() && (c.suite + "/" + c.name).find(opt.filter) == std::string::npos)
+            continue;
+        report(opt, c, measure(c.op, opt.minTimeMs));
+    }
+    return 0;
+}
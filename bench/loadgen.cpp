@@ -0,0 +1,329 @@
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ─── Load Generator ────────────────────────────────────────
+//
+// Drives /search, /budget/optimize, /loadout/build and /price/batch at a
+// fixed arrival rate and reports latency percentiles and throughput per
+// endpoint. Each batch asks for --batch-size names not requested before,
+// so every one is fetched from Steam; a batch with any failed name counts
+// as an error.
+//
+// Requests are scheduled open-loop: request i is due at start + i / rps
+// whether or not earlier ones have finished, and its latency is measured
+// from that due time. When every connection is busy, the wait for one
+// counts against the server instead of silently lowering the offered load.
+//
+//   cs-skin-loadgen [--target=http://localhost:8080] [--rps=50]
+//                   [--duration-sec=10] [--connections=64]
+//                   [--mix=search:6,budget:3,loadout:1]
+//                   [--queries=AK-47,M4A4,...] [--batch-size=1000]
+//                   [--format=table|jsonl]
+
+struct Options {
+    std::string              target      = "http://localhost:8080";
+    double                   rps         = 50.0;
+    double                   durationSec = 10.0;
+    int                      connections = 64;
+    std::map<std::string, int> mix       = {{"search", 6}, {"budget", 3}, {"loadout", 1}};
+    std::vector<std::string> queries     = {
+        "AK-47", "M4A4", "M4A1-S", "AWP", "Desert Eagle", "Glock-18", "USP-S", "Knife",
+        "Gloves", "AK-47 Redline", "AWP Asiimov", "Karambit", "P250", "FAMAS", "Galil AR",
+    };
+    int                      batchSize   = 1000;
+    std::string              format      = "table";
+};
+
+using Clock = std::chrono::steady_clock;
+
+struct Request {
+    std::string endpoint;
+    std::string url;
+    std::string body;   // POST when non-empty
+};
+
+struct InFlight {
+    std::string       endpoint;
+    Clock::time_point due;
+    long long         bytes = 0;
+    std::string       body;   // kept for batches only
+};
+
+struct Samples {
+    std::vector<double> ms;
+    long long           errors = 0;
+    long long           bytes  = 0;
+};
+
+static size_t discard(void* data, size_t size, size_t nmemb, void* userp) {
+    auto* f = static_cast<InFlight*>(userp);
+    f->bytes += static_cast<long long>(size * nmemb);
+    if (f->endpoint == "batch") f->body.append(static_cast<const char*>(data), size * nmemb);
+    return size * nmemb;
+}
+
+// The "failed" count of a /price/batch response; -1 if it has none.
+static long long batchFailures(const std::string& body) {
+    size_t pos = body.rfind("\"failed\":");
+    return pos == std::string::npos ? -1 : std::atoll(body.c_str() + pos + 9);
+}
+
+static std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> out;
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        size_t next = s.find(sep, pos);
+        if (next == std::string::npos) next = s.size();
+        if (next > pos) out.push_back(s.substr(pos, next - pos));
+        pos = next + 1;
+    }
+    return out;
+}
+
+static std::string escape(CURL* curl, const std::string& s) {
+    char*       e = curl_easy_escape(curl, s.c_str(), static_cast<int>(s.size()));
+    std::string out(e ? e : "");
+    curl_free(e);
+    return out;
+}
+
+// Picks the next request from the weighted endpoint mix.
+static Request nextRequest(const Options& opt, std::mt19937& rng, CURL* escaper) {
+    int total = 0;
+    for (const auto& [name, weight] : opt.mix) total += weight;
+    int pick = std::uniform_int_distribution<int>(0, total - 1)(rng);
+
+    std::string endpoint;
+    for (const auto& [name, weight] : opt.mix) {
+        if (pick < weight) { endpoint = name; break; }
+        pick -= weight;
+    }
+
+    const std::string& query = opt.queries[std::uniform_int_distribution<size_t>(0, opt.queries.size() - 1)(rng)];
+    static const int BUDGETS[] = {10, 25, 50, 100, 250, 1000};
+    int budget = BUDGETS[std::uniform_int_distribution<int>(0, 5)(rng)];
+    const char* side = rng() % 2 ? "T" : "CT";
+
+    if (endpoint == "search") {
+        std::string url = opt.target + "/search?q=" + escape(escaper, query);
+        if (rng() % 2) url += "&max=" + std::to_string(budget);
+        return {endpoint, url, ""};
+    }
+    if (endpoint == "batch") {
+        static long long batches = 0;
+        std::string body = "{\"names\": [";
+        for (int j = 0; j < opt.batchSize; j++) {
+            if (j) body += ", ";
+            body += "\"Loadgen " + std::to_string(batches) + "-" + std::to_string(j) + " (Field-Tested)\"";
+        }
+        batches++;
+        return {endpoint, opt.target + "/price/batch", body + "]}"};
+    }
+    if (endpoint == "budget") {
+        return {endpoint, opt.target + "/budget/optimize",
+                "{\"budget\": " + std::to_string(budget) + ", \"query\": \"" + query + "\"}"};
+    }
+    if (rng() % 2) {
+        return {endpoint, opt.target + "/loadout/build",
+                std::string("{\"side\": \"") + side + "\", \"mode\": \"total\", \"total_budget\": " +
+                std::to_string(budget) + ", \"top_k\": 5}"};
+    }
+    return {endpoint, opt.target + "/loadout/build",
+            std::string("{\"side\": \"") + side + "\", \"weapons_budget\": " + std::to_string(budget) +
+            ", \"knife_budget\": " + std::to_string(budget) + ", \"gloves_budget\": " +
+            std::to_string(budget / 2) + "}"};
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+}
+
+static void report(const Options& opt, const std::string& name, Samples& s, double elapsedSec) {
+    std::sort(s.ms.begin(), s.ms.end());
+    double mean = 0.0;
+    for (double v : s.ms) mean += v;
+    if (!s.ms.empty()) mean /= static_cast<double>(s.ms.size());
+
+    double rps = s.ms.size() / elapsedSec;
+    if (opt.format == "jsonl") {
+        std::printf("{\"endpoint\":\"%s\",\"requests\":%zu,\"errors\":%lld,\"rps\":%.1f,\"mean_ms\":%.2f,"
+                    "\"p50_ms\":%.2f,\"p90_ms\":%.2f,\"p99_ms\":%.2f,\"max_ms\":%.2f,\"bytes\":%lld}\n",
+                    name.c_str(), s.ms.size(), s.errors, rps, mean, percentile(s.ms, 0.50),
+                    percentile(s.ms, 0.90), percentile(s.ms, 0.99), s.ms.empty() ? 0.0 : s.ms.back(), s.bytes);
+    } else {
+        std::printf("%-10s %9zu %7lld %8.1f %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                    name.c_str(), s.ms.size(), s.errors, rps, mean, percentile(s.ms, 0.50),
+                    percentile(s.ms, 0.90), percentile(s.ms, 0.99), s.ms.empty() ? 0.0 : s.ms.back());
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](const char* flag) -> const char* {
+            size_t n = std::char_traits<char>::length(flag);
+            return arg.compare(0, n, flag) == 0 ? arg.c_str() + n : nullptr;
+        };
+        if (const char* v = value("--target="))            opt.target      = v;
+        else if (const char* v = value("--rps="))          opt.rps         = std::atof(v);
+        else if (const char* v = value("--duration-sec=")) opt.durationSec = std::atof(v);
+        else if (const char* v = value("--connections="))  opt.connections = std::atoi(v);
+        else if (const char* v = value("--queries="))      opt.queries     = split(v, ',');
+        else if (const char* v = value("--batch-size="))   opt.batchSize   = std::atoi(v);
+        else if (const char* v = value("--format="))       opt.format      = v;
+        else if (const char* v = value("--mix=")) {
+            opt.mix.clear();
+            for (const auto& part : split(v, ',')) {
+                size_t colon = part.find(':');
+                int    w     = colon == std::string::npos ? 1 : std::atoi(part.c_str() + colon + 1);
+                if (w > 0) opt.mix[part.substr(0, colon)] = w;
+            }
+        } else {
+            std::fprintf(stderr, "usage: %s [--target=URL] [--rps=50] [--duration-sec=10] [--connections=64]"
+                                 " [--mix=search:6,budget:3,loadout:1] [--queries=a,b,...]"
+                                 " [--batch-size=1000] [--format=table|jsonl]\n", argv[0]);
+            return 2;
+        }
+    }
+    for (const auto& [name, weight] : opt.mix) {
+        if (name != "search" && name != "budget" && name != "loadout" && name != "batch") {
+            std::fprintf(stderr, "unknown endpoint in --mix: %s\n", name.c_str());
+            return 2;
+        }
+    }
+    if (opt.mix.empty() || opt.queries.empty() || opt.rps <= 0 || opt.connections < 1 || opt.batchSize < 1) {
+        std::fprintf(stderr, "--mix, --queries, --rps, --connections and --batch-size must be non-empty / positive\n");
+        return 2;
+    }
+    while (!opt.target.empty() && opt.target.back() == '/') opt.target.pop_back();
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    CURLM* multi   = curl_multi_init();
+    CURL*  escaper = curl_easy_init();
+    curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(opt.connections));
+
+    struct curl_slist* headers = curl_slist_append(nullptr, "Content-Type: application/json");
+
+    std::mt19937                    rng(12345);
+    std::map<std::string, Samples>  samples;
+    std::vector<CURL*>              idle;
+    long long                       scheduled = 0;
+    long long                       late      = 0;
+    int                             inFlight  = 0;
+
+    auto       started  = Clock::now();
+    auto       deadline = started + std::chrono::duration_cast<Clock::duration>(
+                              std::chrono::duration<double>(opt.durationSec));
+    auto       interval = std::chrono::duration<double>(1.0 / opt.rps);
+
+    while (true) {
+        auto now = Clock::now();
+
+        // Start every request that is due, while a connection is free
+        while (inFlight < opt.connections) {
+            auto due = started + std::chrono::duration_cast<Clock::duration>(interval * scheduled);
+            if (due > now || due >= deadline) break;
+            if (now - due > std::chrono::milliseconds(10)) late++;
+
+            Request r = nextRequest(opt, rng, escaper);
+            CURL*   h;
+            if (!idle.empty()) {
+                h = idle.back();
+                idle.pop_back();
+                curl_easy_reset(h);
+            } else {
+                h = curl_easy_init();
+            }
+
+            auto* f = new InFlight{r.endpoint, due, 0, ""};
+            curl_easy_setopt(h, CURLOPT_URL,             r.url.c_str());
+            curl_easy_setopt(h, CURLOPT_WRITEFUNCTION,   discard);
+            curl_easy_setopt(h, CURLOPT_WRITEDATA,       f);
+            curl_easy_setopt(h, CURLOPT_PRIVATE,         f);
+            curl_easy_setopt(h, CURLOPT_ACCEPT_ENCODING, "gzip");
+            curl_easy_setopt(h, CURLOPT_TIMEOUT,         60L);
+            if (!r.body.empty()) {
+                curl_easy_setopt(h, CURLOPT_HTTPHEADER,      headers);
+                curl_easy_setopt(h, CURLOPT_COPYPOSTFIELDS,  r.body.c_str());
+            }
+            curl_multi_add_handle(multi, h);
+            inFlight++;
+            scheduled++;
+        }
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        CURLMsg* msg;
+        int      queued;
+        while ((msg = curl_multi_info_read(multi, &queued))) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            CURL*     h = msg->easy_handle;
+            InFlight* f = nullptr;
+            curl_easy_getinfo(h, CURLINFO_PRIVATE, reinterpret_cast<char**>(&f));
+
+            long status = 0;
+            curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &status);
+
+            Samples& s = samples[f->endpoint];
+            s.ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - f->due).count());
+            s.bytes += f->bytes;
+            if (msg->data.result != CURLE_OK || status >= 400) s.errors++;
+            else if (f->endpoint == "batch" && batchFailures(f->body) != 0) s.errors++;
+
+            curl_multi_remove_handle(multi, h);
+            idle.push_back(h);
+            delete f;
+            inFlight--;
+        }
+
+        auto nextDue = started + std::chrono::duration_cast<Clock::duration>(interval * scheduled);
+        if (inFlight == 0 && nextDue >= deadline) break;
+
+        // Wake for socket activity or the next due request
+        int waitMs = 100;
+        if (nextDue < deadline && inFlight < opt.connections) {
+            auto until = std::chrono::duration_cast<std::chrono::milliseconds>(nextDue - Clock::now()).count();
+            waitMs = static_cast<int>(std::clamp<long long>(until, 0, 100));
+        }
+        if (inFlight > 0)
+            curl_multi_poll(multi, nullptr, 0, waitMs, nullptr);
+        else if (waitMs > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
+    }
+
+    double elapsedSec = std::chrono::duration<double>(Clock::now() - started).count();
+
+    if (opt.format != "jsonl") {
+        std::printf("target %s | offered %.1f rps for %.1fs | %d connections | %lld started late\n\n",
+                    opt.target.c_str(), opt.rps, opt.durationSec, opt.connections, late);
+        std::printf("endpoint    requests  errors      rps   mean_ms    p50_ms    p90_ms    p99_ms    max_ms\n");
+    }
+
+    Samples all;
+    for (auto& [name, s] : samples) {
+        all.ms.insert(all.ms.end(), s.ms.begin(), s.ms.end());
+        all.errors += s.errors;
+        all.bytes  += s.bytes;
+        report(opt, name, s, elapsedSec);
+    }
+    report(opt, "all", all, elapsedSec);
+
+    for (CURL* h : idle) curl_easy_cleanup(h);
+    curl_easy_cleanup(escaper);
+    curl_slist_free_all(headers);
+    curl_multi_cleanup(multi);
+    curl_global_cleanup();
+    return all.errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,283 @@
+#include "crow_all.h"
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+// ─── Mock Steam Market ─────────────────────────────────────
+//
+// Stands in for steamcommunity.com during load tests: serves
+// /market/search/render/ and /market/priceoverview/ with configurable
+// latency, jitter and injected 429s. Search pages come from recorded
+// fixtures when one matches (search_<query>_<sort>_<start>.json, query
+// lowercased with non-alphanumerics dropped); every other query gets a
+// deterministic synthetic catalog in Steam's response format.
+//
+//   cs-skin-mock-steam [--port=9090] [--latency-ms=80] [--jitter-ms=40]
+//                      [--rate-429=0] [--retry-after-sec=5] [--threads=64]
+//                      [--fixtures=DIR]
+//
+// Run the API against it with SKIN_STEAM_BASE_URL=http://localhost:9090.
+// GET /mock/stats reports how many requests reached the mock.
+
+struct Options {
+    int         port          = 9090;
+    int         latencyMs     = 80;
+    int         jitterMs      = 40;
+    double      rate429       = 0.0;
+    int         retryAfterSec = 5;
+    int         threads       = 64;
+    std::string fixtures      = BENCH_FIXTURE_DIR;
+};
+
+static std::atomic<long long> searchRequests{0};
+static std::atomic<long long> priceRequests{0};
+static std::atomic<long long> throttled{0};
+
+static uint64_t fnv1a(const std::string& s, uint64_t h = 0xcbf29ce484222325ULL) {
+    for (unsigned char c : s)
+        h = (h ^ c) * 0x100000001b3ULL;
+    return h;
+}
+
+static std::string slug(const std::string& query) {
+    std::string out;
+    for (unsigned char c : query)
+        if (std::isalnum(c)) out.push_back(static_cast<char>(std::tolower(c)));
+    return out;
+}
+
+static std::string priceText(int cents) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "$%d.%02d", cents / 100, cents % 100);
+    return buf;
+}
+
+// Loads search_<slug>_<sort>_<start>.json fixtures keyed on their file stem.
+static std::map<std::string, std::string> loadFixtures(const std::string& dir) {
+    std::map<std::string, std::string> fixtures;
+    std::error_code ec;
+    for (const auto& e : std::filesystem::directory_iterator(dir, ec)) {
+        if (e.path().extension() != ".json") continue;
+        std::ifstream in(e.path(), std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        fixtures[e.path().stem().string()] = ss.str();
+    }
+    return fixtures;
+}
+
+struct MockItem {
+    std::string name;
+    int         price;
+    int         listings;
+    uint64_t    id;
+};
+
+// The query's synthetic catalog: 50..449 items, fixed per query.
+static std::vector<MockItem> catalogFor(const std::string& query) {
+    static const char* WEARS[] = {
+        "Factory New", "Minimal Wear", "Field-Tested", "Well-Worn", "Battle-Scarred",
+    };
+
+    uint64_t qh    = fnv1a(query);
+    int      total = 50 + static_cast<int>(qh % 400);
+
+    std::vector<MockItem> items;
+    items.reserve(total);
+    for (int j = 0; j < total; j++) {
+        uint64_t h = fnv1a(std::to_string(j), qh);
+        // Log-uniform between $0.03 and ~$3,000, like the real market
+        double   u = static_cast<double>(h % 1000000) / 1000000.0;
+        MockItem it;
+        it.price    = static_cast<int>(3.0 * std::pow(100000.0, u));
+        it.listings = 1 + static_cast<int>((h >> 20) % 5000);
+        it.id       = h;
+        it.name     = query + " | Mock " + std::to_string(j / 5) + " (" + WEARS[j % 5] + ")";
+        items.push_back(std::move(it));
+    }
+    return items;
+}
+
+static std::string searchPage(const std::string& query, const std::string& sortCol,
+                              const std::string& sortDir, int start, int count) {
+    std::vector<MockItem> items = catalogFor(query);
+    bool asc = sortDir == "asc";
+    std::stable_sort(items.begin(), items.end(), [&](const MockItem& a, const MockItem& b) {
+        long long ka = sortCol == "price" ? a.price : a.listings;
+        long long kb = sortCol == "price" ? b.price : b.listings;
+        return asc ? ka < kb : ka > kb;
+    });
+
+    json results = json::array();
+    for (int i = start; i < start + count && i < static_cast<int>(items.size()); i++) {
+        const MockItem& it = items[i];
+        char icon[40];
+        std::snprintf(icon, sizeof(icon), "mock-%016llx", static_cast<unsigned long long>(it.id));
+
+        results.push_back({
+            {"name",            it.name},
+            {"hash_name",       it.name},
+            {"sell_listings",   it.listings},
+            {"sell_price",      it.price},
+            {"sell_price_text", priceText(it.price)},
+            {"app_icon",        "https://cdn.fastly.steamstatic.com/steamcommunity/public/images/apps/730/mock.jpg"},
+            {"app_name",        "Counter-Strike 2"},
+            {"asset_description", {
+                {"appid",            730},
+                {"classid",          std::to_string(it.id % 10000000000ULL)},
+                {"instanceid",       "0"},
+                {"icon_url",         icon},
+                {"tradable",         1},
+                {"name",             it.name},
+                {"type",             "Mil-Spec Grade Rifle"},
+                {"market_name",      it.name},
+                {"market_hash_name", it.name},
+                {"commodity",        0},
+            }},
+            {"sale_price_text", priceText(std::max(1, it.price * 95 / 100))},
+        });
+    }
+
+    json page = {
+        {"success",     true},
+        {"start",       start},
+        {"pagesize",    count},
+        {"total_count", items.size()},
+        {"searchdata",  {{"query", query}, {"search_descriptions", false}, {"total_count", items.size()},
+                         {"pagesize", count}, {"prefix", "searchResults"}, {"class_prefix", "market"}}},
+        {"results",     std::move(results)},
+    };
+    return page.dump();
+}
+
+// Sleeps for the configured latency and jitter, then decides whether this
+// request is answered with 429 instead.
+static bool delayAndThrottle(const Options& opt) {
+    thread_local std::mt19937 rng(std::random_device{}());
+
+    int delay = opt.latencyMs;
+    if (opt.jitterMs > 0)
+        delay += std::uniform_int_distribution<int>(-opt.jitterMs, opt.jitterMs)(rng);
+    if (delay > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+
+    return opt.rate429 > 0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng) < opt.rate429;
+}
+
+static crow::response tooManyRequests(const Options& opt) {
+    throttled++;
+    crow::response res(429);
+    res.set_header("Retry-After", std::to_string(opt.retryAfterSec));
+    res.set_header("Content-Type", "text/html");
+    res.body = "<html><body>Too Many Requests</body></html>";
+    return res;
+}
+
+static crow::response jsonResponse(std::string body) {
+    crow::response res(200);
+    res.set_header("Content-Type", "application/json; charset=utf-8");
+    res.body = std::move(body);
+    return res;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](const char* flag) -> const char* {
+            size_t n = std::char_traits<char>::length(flag);
+            return arg.compare(0, n, flag) == 0 ? arg.c_str() + n : nullptr;
+        };
+        if (const char* v = value("--port="))                 opt.port          = std::atoi(v);
+        else if (const char* v = value("--latency-ms="))      opt.latencyMs     = std::atoi(v);
+        else if (const char* v = value("--jitter-ms="))       opt.jitterMs      = std::atoi(v);
+        else if (const char* v = value("--rate-429="))        opt.rate429       = std::atof(v);
+        else if (const char* v = value("--retry-after-sec=")) opt.retryAfterSec = std::atoi(v);
+        else if (const char* v = value("--threads="))         opt.threads       = std::atoi(v);
+        else if (const char* v = value("--fixtures="))        opt.fixtures      = v;
+        else {
+            std::fprintf(stderr, "usage: %s [--port=9090] [--latency-ms=80] [--jitter-ms=40] [--rate-429=0]"
+                                 " [--retry-after-sec=5] [--threads=64] [--fixtures=DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    static const std::map<std::string, std::string> fixtures = loadFixtures(opt.fixtures);
+
+    crow::SimpleApp app;
+    app.loglevel(crow::LogLevel::Warning);
+
+    // GET /market/search/render/?query=...&start=0&count=10&sort_column=price&sort_dir=desc
+    CROW_ROUTE(app, "/market/search/render/")([&opt](const crow::request& req) {
+        searchRequests++;
+        if (delayAndThrottle(opt)) return tooManyRequests(opt);
+
+        auto param = [&](const char* key, const char* fallback) {
+            const char* v = req.url_params.get(key);
+            return std::string(v ? v : fallback);
+        };
+        std::string query   = param("query", "");
+        std::string sortCol = param("sort_column", "popular");
+        std::string sortDir = param("sort_dir", "desc");
+        int         start   = std::max(0, std::atoi(param("start", "0").c_str()));
+        int         count   = std::clamp(std::atoi(param("count", "10").c_str()), 1, 100);
+
+        auto fixture = fixtures.find("search_" + slug(query) + "_" + sortCol + "_" + std::to_string(start));
+        if (fixture != fixtures.end())
+            return jsonResponse(fixture->second);
+        return jsonResponse(searchPage(query, sortCol, sortDir, start, count));
+    });
+
+    // GET /market/priceoverview/?market_hash_name=...
+    CROW_ROUTE(app, "/market/priceoverview/")([&opt](const crow::request& req) {
+        priceRequests++;
+        if (delayAndThrottle(opt)) return tooManyRequests(opt);
+
+        const char* name  = req.url_params.get("market_hash_name");
+        uint64_t    h     = fnv1a(name ? name : "");
+        int         price = 3 + static_cast<int>(h % 50000);
+
+        json r = {
+            {"success",      true},
+            {"lowest_price", priceText(price)},
+            {"volume",       std::to_string(1 + (h >> 16) % 2000)},
+            {"median_price", priceText(price + price / 20)},
+        };
+        return jsonResponse(r.dump());
+    });
+
+    // GET /mock/stats
+    CROW_ROUTE(app, "/mock/stats")([]() {
+        crow::json::wvalue r;
+        r["search_requests"] = searchRequests.load();
+        r["price_requests"]  = priceRequests.load();
+        r["throttled"]       = throttled.load();
+        return r;
+    });
+
+    std::cerr << "[mock-steam] port " << opt.port << " | latency " << opt.latencyMs << "±" << opt.jitterMs
+              << "ms | 429 rate " << opt.rate429 << " | " << fixtures.size() << " fixtures" << std::endl;
+    app.port(static_cast<uint16_t>(opt.port)).concurrency(std::max(1, opt.threads)).run();
+
+    std::cerr << "[mock-steam] served " << searchRequests.load() << " search, " << priceRequests.load()
+              << " priceoverview, " << throttled.load() << " throttled" << std::endl;
+    return 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "subset_sum.h"
+#include "skin.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ─── Budget Table Cache ────────────────────────────────────
+//
+// SubsetSumTables for the item sets behind /budget/optimize and
+// /budget/sweep, keyed by the skins' fingerprint (skinsFingerprint()). Each
+// table covers every budget up to MAX_BUDGET_CENTS, so dragging a budget
+// slider over one query builds it once and every later step is a lookup.
+// Entries are evicted least-recently-used once the byte budget is reached.
+
+// The $10,000 cap on the /budget routes.
+constexpr int MAX_BUDGET_CENTS = 1000000;
+
+using SubsetSumTablePtr = std::shared_ptr<const SubsetSumTable>;
+
+struct BudgetTableStats {
+    long long hits;
+    long long misses;
+    size_t    entries;
+    size_t    bytes;
+};
+
+class BudgetTableCache {
+public:
+    explicit BudgetTableCache(size_t maxBytes);
+
+    // The table for `skins`, built on a miss. `key` must be the skins'
+    // fingerprint, so a cached table's indices match `skins`. `cached`, if
+    // given, reports whether the table came from the cache.
+    SubsetSumTablePtr get(const std::string& key, const std::vector<Skin>& skins, bool* cached = nullptr);
+
+    BudgetTableStats stats() const;
+
+private:
+    using Lru = std::list<std::pair<std::string, SubsetSumTablePtr>>;
+
+    size_t maxBytes_;
+
+    mutable std::mutex                             mutex_;
+    Lru                                            lru_;     // most recent first
+    std::unordered_map<std::string, Lru::iterator> index_;
+    size_t                                         bytes_ = 0;
+
+    std::atomic<long long> hits_{0};
+    std::atomic<long long> misses_{0};
+};
+
+// Shared instance, sized from SKIN_BUDGET_TABLE_MB (default 64).
+BudgetTableCache& budgetTables();
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "market_cache.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// ─── Catalog Snapshot ──────────────────────────────────────
+//
+// Binary dump of the market cache so a restarted server can answer from
+// its last known catalog instead of sending every first request to Steam.
+//
+// Layout (native byte order, every section 8-byte aligned):
+//
+//   SnapshotHeader                          magic, version, counts, checksum
+//   SnapshotPage[pageCount]                 cache key + range of skins
+//   SnapshotSkin[skinCount]                 fixed-width skin records
+//   char[arenaBytes]                        deduplicated string bytes
+//
+// Strings are (offset, length) references into the arena and are interned
+// again on load. The checksum covers everything after the header. Loading
+// maps the file and builds pages straight from the records; nothing is
+// re-parsed.
+
+struct SnapshotInfo {
+    size_t pages = 0;
+    size_t items = 0;
+    size_t bytes = 0;
+    double ms    = 0.0;
+};
+
+// Writes every cached page to `path` (via a temp file and rename, so a
+// crash never leaves a torn snapshot). Returns false on I/O failure.
+bool writeSnapshot(const MarketCache& cache, const std::string& path, SnapshotInfo* info = nullptr);
+
+// Maps `path` and restores its pages into `cache`, skipping pages older
+// than `maxAge`. Returns false if the file is missing, truncated, from
+// another format version or fails its checksum.
+bool loadSnapshot(MarketCache& cache, const std::string& path,
+                  std::chrono::seconds maxAge, SnapshotInfo* info = nullptr);
+
+// Background thread that rewrites the snapshot every `interval` when the
+// cache has changed, plus once more on stop().
+class SnapshotWriter {
+public:
+    SnapshotWriter(MarketCache& cache, std::string path, std::chrono::seconds interval);
+    ~SnapshotWriter();
+
+    void start();
+    void stop();
+
+private:
+    void run();
+    void writeIfChanged();
+
+    MarketCache&         cache_;
+    std::string          path_;
+    std::chrono::seconds interval_;
+    long long            written_ = -1;  // cache generation last written
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    bool                    stopping_ = false;
+    std::thread             thread_;
+};
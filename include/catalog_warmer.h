@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ─── Catalog Warmer ────────────────────────────────────────
+//
+// Background scheduler that keeps hot queries pre-fetched in the market
+// cache, so user requests are served from memory instead of waiting on
+// Steam. The warm set is the fixed loadout queries (pinned) plus the most
+// requested /search terms; each is refreshed once per interval, most
+// requested first, and only while the shared Steam limiter has headroom
+// left over from user traffic. Its page fetches also queue behind user
+// requests in the upstream reactor (see warmQuery()).
+
+struct WarmResult {
+    int pagesOk    = 0;
+    int pagesTotal = 0;
+    int items      = 0;
+};
+
+struct WarmStatus {
+    std::string query;
+    bool        pinned;
+    int         pages;
+    double      age_seconds;     // -1 if never refreshed
+    double      due_in_seconds;  // <= 0 when due now
+    double      recent_requests; // decayed request count
+    int         items;
+    int         pages_ok;
+    double      last_refresh_ms;
+    long long   refreshes;
+};
+
+class CatalogWarmer {
+public:
+    using Refresh = std::function<WarmResult(const std::string& query, int pages)>;
+
+    struct Config {
+        std::chrono::seconds interval;       // refresh period per query
+        int                  hotQueries;     // how many top /search terms to warm
+        int                  hotPages;       // pages per hot query
+        double               headroom;       // limiter tokens left for user traffic
+        double               halfLifeSec;    // decay of request counters
+    };
+
+    explicit CatalogWarmer(Config config);
+    ~CatalogWarmer();
+
+    // Queries that are always kept warm.
+    void pin(const std::string& query, int pages);
+
+    // Counts a user request for `query`; frequent queries join the warm set.
+    void recordQuery(const std::string& query);
+
+    void start(Refresh refresh);
+    void stop();
+
+    std::vector<WarmStatus> status();
+    const Config&           config() const { return config_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Unpinned queries keyed on rankLocked(), coldest first.
+    using Ranking = std::multimap<double, std::string>;
+
+    struct Entry {
+        bool              pinned    = false;
+        int               pages     = 0;
+        double            score     = 0.0;   // decayed request count as of scoredAt
+        Clock::time_point scoredAt  = Clock::now();
+        bool              refreshed = false;
+        Clock::time_point refreshedAt;
+        WarmResult        last;
+        double            lastMs    = 0.0;
+        long long         refreshes = 0;
+        Ranking::iterator rank;              // into ranking_, unless pinned
+    };
+
+    double                   decayedLocked(const Entry& e, Clock::time_point now) const;
+    double                   rankLocked(const Entry& e) const;
+    std::vector<std::string> warmSetLocked(Clock::time_point now) const;
+    std::string              pickLocked(Clock::time_point now, Clock::time_point* nextDue);
+    void                     run();
+
+    Config  config_;
+    Refresh refresh_;
+
+    std::mutex                   mutex_;
+    std::condition_variable      wake_;
+    std::map<std::string, Entry> entries_;
+    Ranking                      ranking_;
+    const Clock::time_point      origin_ = Clock::now();
+    bool                         stopping_ = false;
+    std::thread                  thread_;
+};
+
+// Shared instance, configured from SKIN_WARM_INTERVAL_SEC (default 240),
+// SKIN_WARM_HOT_QUERIES (default 10), SKIN_WARM_HOT_PAGES (default 10) and
+// SKIN_WARM_HEADROOM (default half the Steam burst).
+CatalogWarmer& catalogWarmer();
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// ─── Upstream Circuit Breaker ──────────────────────────────
+//
+// Stops sending to Steam while it is refusing us. After `failures`
+// consecutive failed transfers (429, 5xx or no response) the breaker opens
+// and the reactor rejects every transfer at once, so callers fall back to
+// cached data instead of queueing behind timeouts. Once the open period
+// has passed a single probe goes out: success closes the breaker, failure
+// reopens it for twice as long (up to `maxOpen`). A Retry-After longer
+// than the open period extends it.
+//
+// Transfers sent before the breaker opened may finish after it. Their
+// outcome says nothing about whether Steam has recovered, so while the
+// breaker is not closed only the probe's outcome moves it.
+
+enum class BreakerState { Closed, Open, HalfOpen };
+
+struct BreakerConfig {
+    int                  failures;   // consecutive failures that open it
+    std::chrono::seconds open;       // first open period
+    std::chrono::seconds maxOpen;    // cap for repeated failed probes
+};
+
+struct BreakerStats {
+    BreakerState state;
+    long long    opens;
+    long long    rejected;
+    double       retryInSeconds;     // until the next probe, 0 unless open
+};
+
+class CircuitBreaker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit CircuitBreaker(BreakerConfig config);
+
+    // Whether a transfer may be sent now. In the half-open state only the
+    // first caller gets through, as the probe; `probe` is set for it and
+    // must be passed back with its outcome.
+    bool allow(bool* probe);
+
+    // True while transfers would be refused, so queued work can be dropped
+    // without asking allow() for each.
+    bool isOpen();
+
+    void succeeded(bool probe);
+    void failed(std::chrono::seconds retryAfter, bool probe);
+
+    // Counts a transfer refused by allow() or dropped while open.
+    void rejected() { rejected_++; }
+
+    BreakerStats stats();
+
+private:
+    void openLocked(Clock::time_point now, std::chrono::seconds retryAfter);
+
+    BreakerConfig config_;
+
+    std::mutex           mutex_;
+    BreakerState         state_       = BreakerState::Closed;
+    int                  consecutive_ = 0;
+    bool                 probing_     = false;
+    std::chrono::seconds openFor_;
+    Clock::time_point    openUntil_;
+
+    std::atomic<long long> opens_{0};
+    std::atomic<long long> rejected_{0};
+};
+
+const char* breakerStateName(BreakerState state);
+
+// Shared Steam breaker: SKIN_BREAKER_FAILURES (default 5),
+// SKIN_BREAKER_OPEN_SEC (default 10), SKIN_BREAKER_MAX_OPEN_SEC (default 300).
+CircuitBreaker& upstreamBreaker();
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+
+// ─── Runtime Configuration ─────────────────────────────────
+//
+// Tunables are read from environment variables so a deployment can adjust
+// them without a rebuild. Unset or malformed values fall back to the default.
+
+inline int envInt(const char* name, int fallback) {
+    const char* raw = std::getenv(name);
+    if (!raw || !*raw) return fallback;
+    char* end = nullptr;
+    long v = std::strtol(raw, &end, 10);
+    if (end == raw || *end != '\0') return fallback;
+    return static_cast<int>(v);
+}
+
+inline std::string envString(const char* name, const std::string& fallback) {
+    const char* raw = std::getenv(name);
+    return (raw && *raw) ? std::string(raw) : fallback;
+}
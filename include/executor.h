@@ -0,0 +1,73 @@
+#pragma once
+
+#include "metrics.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ─── Executors ─────────────────────────────────────────────
+//
+// Bounded pools of worker threads. Request handlers never block on Steam
+// themselves: their fetches go through the upstream reactor, and the work
+// that follows runs on the compute pool. The upstream pool is left for
+// /search/stream, which still consumes pages on a thread of its own.
+//
+// Tasks must not block on other tasks of the same executor.
+//
+// Each pool reports its size and the time its workers spend running jobs
+// under pool="<name>" on /metrics.
+
+class Executor {
+public:
+    Executor(int threads, const std::string& name);
+    ~Executor();
+
+    Executor(const Executor&)            = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    template <typename F>
+    auto submit(F&& fn) -> std::future<decltype(fn())> {
+        using R  = decltype(fn());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+        std::future<R> result = task->get_future();
+        post([task]() { (*task)(); });
+        return result;
+    }
+
+    // Runs `job` on a worker without a future.
+    void post(std::function<void()> job);
+
+    int threads() const { return static_cast<int>(workers_.size()); }
+
+private:
+    void run();
+
+    std::mutex                        mutex_;
+    std::condition_variable           ready_;
+    std::deque<std::function<void()>> queue_;
+    bool                              stopping_ = false;
+    std::vector<std::thread>          workers_;
+    Counter&                          busyNs_;
+};
+
+// Shared executor for blocking upstream work (the /search/stream socket,
+// which consumes pages in order on its own thread), sized by
+// SKIN_UPSTREAM_THREADS (default 16).
+Executor& upstreamExecutor();
+
+// Shared executor for the CPU half of asynchronous requests (index lookups,
+// optimizers, serialization) once their pages have arrived, sized by
+// SKIN_COMPUTE_THREADS (default: CPU count).
+Executor& computeExecutor();
+
+// Continues a request after an asynchronous fetch: runs `work` inline when
+// still on `origin` (everything was cached), otherwise on the compute
+// executor, so CPU work never runs on the upstream reactor thread.
+void resumeRequest(std::thread::id origin, std::function<void()> work);
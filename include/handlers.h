@@ -0,0 +1,77 @@
+#pragma once
+
+#include "crow_all.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+// ─── Route Handlers ────────────────────────────────────────
+//
+// The HTTP API, independent of the Crow app that routes to it, so the same
+// code paths can be driven directly (e.g. by the benchmarks). Request and
+// response shapes are documented in README.md.
+//
+// Handlers that may need Steam return before their response is ready and
+// deliver it later through `respond`, exactly once, from whichever thread
+// finished the work (inline when everything was cached). `req` must stay
+// valid until then.
+
+using Respond = std::function<void(crow::response res)>;
+
+// Crow middleware recording per-route latency, status codes and handler
+// busy time for /metrics. Paths outside the API are counted as "other".
+// Latency runs until the response is sent; for a deferred response the
+// route records how long its handler actually held the worker.
+struct RequestMetrics {
+    struct context {
+        std::chrono::steady_clock::time_point began;
+        bool                                  deferred = false;
+        std::chrono::steady_clock::duration   handled{};
+    };
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+};
+
+// GET /metrics
+crow::response handleMetrics();
+
+// GET /cache/stats
+crow::response handleCacheStats();
+
+// GET /catalog/status
+crow::response handleCatalogStatus();
+
+// GET /search?q=AK-47&min=0&max=300
+void handleSearch(const crow::request& req, Respond respond);
+
+// GET /price?name=AK-47+Redline+(Field-Tested)
+void handlePrice(const crow::request& req, Respond respond);
+
+// POST /price/batch
+// Body: { "names": ["AK-47 | Redline (Field-Tested)", ...] }
+void handlePriceBatch(const crow::request& req, Respond respond);
+
+// Parses a /price/batch body into its names. Returns an empty list and
+// sets `error` when the body is invalid or over SKIN_PRICE_BATCH_MAX.
+std::vector<std::string> priceBatchNames(const std::string& body, std::string* error);
+
+// GET /history?name=AK-47+Redline+(Field-Tested)&from=&to=&step=
+crow::response handleHistory(const crow::request& req);
+
+// POST /budget/optimize
+// Body: { "budget": 50.00, "query": "AK-47" }
+void handleBudgetOptimize(const crow::request& req, Respond respond);
+
+// GET /budget/sweep?query=AK-47&max=100&step=5&skins=1
+// The best spend for every budget step, step*2, ... up to max, from the
+// same precomputed table as /budget/optimize. `skins=1` adds each chosen set.
+void handleBudgetSweep(const crow::request& req, Respond respond);
+
+// POST /loadout/build
+// Body: split mode { "side", "weapons_budget", "knife_budget", "gloves_budget" }
+// or joint mode { "side", "mode": "total", "total_budget", "include_knife",
+// "include_gloves", "top_k" }
+void handleLoadoutBuild(const crow::request& req, Respond respond);
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <curl/curl.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ─── CURL Helpers ──────────────────────────────────────────
+//
+// Upstream requests reuse pooled easy handles that share one CURLSH
+// DNS / TLS-session / connection cache, so repeated calls to
+// steamcommunity.com ride an existing keep-alive connection instead of
+// paying a fresh TCP+TLS handshake each time.
+
+// Percent-encodes everything except RFC 3986 unreserved characters.
+// Equivalent to curl_easy_escape() without needing a handle.
+std::string urlEncode(const std::string& str);
+
+// ─── Upstream Reactor ──────────────────────────────────────
+//
+// Every Steam transfer runs on one reactor thread that drives a single
+// curl_multi handle, so a request waiting on Steam holds no thread of its
+// own. Queued transfers start as soon as the shared Steam limiter grants a
+// token, with at most SKIN_UPSTREAM_MAX_INFLIGHT (default 32) in flight
+// across the process.
+//
+// Transfers wait in one of two queues. Interactive ones, which a user
+// request is waiting on, always start first. Background ones (catalog
+// warming, stale-page refreshes, price batches) start only while no
+// interactive transfer is waiting and the bucket holds more than
+// SKIN_UPSTREAM_BACKGROUND_RESERVE tokens (default half the burst). So
+// background work never queues ahead of a user and leaves a few tokens
+// for the next one.
+//
+// Every outcome feeds the limiter's pacing and the upstream breaker. A
+// transfer is rejected without being sent while the breaker is open, or
+// when it could not start within its queue's wait limit:
+// SKIN_UPSTREAM_MAX_WAIT_MS (default 10000) for interactive transfers,
+// SKIN_UPSTREAM_BACKGROUND_MAX_WAIT_MS (default 60000) for background ones.
+
+// The outcome of one GET.
+struct FetchResult {
+    long                 status = 0;          // HTTP status; 0 if there was no response
+    std::string          body;
+    std::chrono::seconds retryAfter{0};       // from a 429 or 503
+    bool                 rejected = false;    // never sent (breaker open or queued too long)
+
+    bool ok() const { return status >= 200 && status < 300; }
+};
+
+enum class FetchPriority { Interactive, Background };
+
+// Why a fetch did not succeed, for logs and error messages.
+std::string describeFailure(const FetchResult& result);
+
+using FetchCallback = std::function<void(const FetchResult& result)>;
+
+// Queues a GET and returns immediately. `done` runs on the reactor thread,
+// so it must be quick and must not block; hand longer work to an executor.
+void fetchAsync(std::string url, FetchCallback done,
+                FetchPriority priority = FetchPriority::Interactive);
+
+// Moves a queued background transfer of `url` to the interactive queue,
+// for when a user request starts waiting on it (a shared fetch). A no-op
+// if it has already started; one queued within the next second is still
+// promoted.
+void promoteFetch(std::string url);
+
+// Joins the reactor thread, dropping transfers still queued or running
+// without calling back. For shutdown, before static destructors run: the
+// objects completions touch (the curl pool, limiter, breaker, caches) are
+// ordinary statics. Later fetches are discarded.
+void stopUpstream();
+
+// Receives one result of a multi-URL fetch, by index into the URL list.
+using FetchDone = std::function<void(size_t index, const FetchResult& result)>;
+
+class CurlPool {
+public:
+    CurlPool();
+    ~CurlPool();
+
+    CurlPool(const CurlPool&)            = delete;
+    CurlPool& operator=(const CurlPool&) = delete;
+
+    // Returns a configured handle (pooled or new). Per-request options such
+    // as CURLOPT_URL and CURLOPT_WRITEDATA are left for the caller to set.
+    CURL* acquire();
+    void  release(CURL* handle);
+
+private:
+    static void lockShared(CURL*, curl_lock_data data, curl_lock_access, void* userptr);
+    static void unlockShared(CURL*, curl_lock_data data, void* userptr);
+
+    CURLSH*            share_   = nullptr;
+    struct curl_slist* headers_ = nullptr;
+    std::mutex         shareLocks_[CURL_LOCK_DATA_LAST];
+
+    std::mutex         mutex_;
+    std::vector<CURL*> idle_;
+};
+
+CurlPool& curlPool();
+
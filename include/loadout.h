@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// ─── Joint Loadout Optimizer ───────────────────────────────
+//
+// Multiple-choice knapsack: pick exactly one candidate per slot so that the
+// combined value is maximal while the combined price stays under one cap,
+// and return the k best complete loadouts.
+//
+// Each slot is first reduced to candidates that can still fit next to the
+// cheapest pick of every other slot, and that fewer than k others dominate
+// (cost no more and are worth at least as much): a candidate with k such
+// rivals can never be in the top k, since swapping in each rival gives k
+// loadouts at least as good. With k == 1 this is the Pareto frontier.
+//
+// The slots are then split into two halves. The second half's combinations
+// are pruned the same way and sorted by price; every combination of the
+// first half takes the affordable prefix of that list by binary search,
+// and a max-heap pops the best partner in each prefix, splitting the
+// prefix around it (range maximum via a sparse table) to find the next
+// best. With four slots of a few hundred candidates this is a few hundred
+// thousand combinations, well within a synchronous request.
+
+struct SlotCandidate {
+    int price;  // cents
+    int value;
+};
+
+struct LoadoutPick {
+    std::vector<int> choice;  // candidate index per slot
+    long long        price = 0;
+    long long        value = 0;
+};
+
+struct LoadoutStats {
+    size_t candidates = 0;  // across all slots, before pruning
+    size_t kept       = 0;  // after per-slot frontier pruning
+    size_t combos     = 0;  // half-combinations enumerated
+};
+
+std::vector<LoadoutPick> optimizeLoadouts(
+    const std::vector<std::vector<SlotCandidate>>& slots,
+    long long                                      cap,
+    int                                            k,
+    LoadoutStats*                                  stats = nullptr
+);
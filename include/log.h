@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <sstream>
+#include <string>
+
+// ─── Logging ───────────────────────────────────────────────
+//
+// Leveled logger with a background writer. A log statement formats its
+// line on the calling thread and queues it; one writer thread batches
+// queued lines to stderr, so request threads never wait on the terminal
+// or contend on stderr. Statements below the current level are skipped
+// before any of their arguments are formatted.
+//
+//   LOG_INFO("snapshot") << "Wrote " << pages << " pages";
+//
+// The level comes from SKIN_LOG_LEVEL (debug, info, warn, error, off;
+// default info). When the queue is full, lines are dropped and counted
+// rather than blocking the caller.
+
+enum class LogLevel { Debug = 0, Info = 1, Warn = 2, Error = 3, Off = 4 };
+
+extern std::atomic<int> currentLogLevel;
+
+inline bool logEnabled(LogLevel level) {
+    return static_cast<int>(level) >= currentLogLevel.load(std::memory_order_relaxed);
+}
+
+void setLogLevel(LogLevel level);
+
+// Blocks until every line queued so far has been written.
+void flushLogs();
+
+// One log line; queued when it goes out of scope.
+class LogLine {
+public:
+    LogLine(LogLevel level, const char* tag);
+    ~LogLine();
+
+    LogLine(const LogLine&)            = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    template <typename T>
+    LogLine& operator<<(const T& value) {
+        out_ << value;
+        return *this;
+    }
+
+private:
+    std::ostringstream out_;
+};
+
+// Turns a whole `LogLine(...) << a << b` chain into a void expression, so
+// SKIN_LOG can be a conditional expression rather than an if/else that
+// would capture an `else` following an unbraced log statement. `&` binds
+// looser than `<<`, so it applies to the finished chain.
+struct LogVoidify {
+    void operator&(const LogLine&) {}
+};
+
+#define SKIN_LOG(level, tag) !logEnabled(level) ? (void)0 : LogVoidify() & LogLine(level, tag)
+#define LOG_DEBUG(tag) SKIN_LOG(LogLevel::Debug, tag)
+#define LOG_INFO(tag)  SKIN_LOG(LogLevel::Info,  tag)
+#define LOG_WARN(tag)  SKIN_LOG(LogLevel::Warn,  tag)
+#define LOG_ERROR(tag) SKIN_LOG(LogLevel::Error, tag)
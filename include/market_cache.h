@@ -0,0 +1,118 @@
+#pragma once
+
+#include "skin.h"
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ─── Market Page Cache ─────────────────────────────────────
+//
+// Process-wide TTL cache of parsed Steam market search pages, keyed by
+// (query, sort_column, sort_dir, start). Pages are stored unfiltered so any
+// min/max price window can be served from the same entry.
+//
+// Entries older than the TTL are still returned (stale-while-revalidate);
+// the first reader to see a stale entry claims its refresh so only one
+// background fetch per page is in flight.
+//
+// Once full, the least recently read or stored page is evicted.
+
+struct PageKey {
+    std::string query;
+    std::string sortCol;
+    std::string sortDir;
+    int         start;
+
+    std::string str() const;
+};
+
+using SkinPage = std::shared_ptr<const std::vector<Skin>>;
+
+enum class CacheState { Hit, Stale, Miss };
+
+struct CacheLookup {
+    SkinPage   page;
+    CacheState state;
+    bool       refreshClaimed = false;  // caller must refresh (Stale only)
+    double     ageSeconds     = 0.0;    // since the page was fetched
+};
+
+// A cached page as exported for snapshots, with its wall-clock fetch time.
+struct CachedPage {
+    PageKey                               key;
+    SkinPage                              page;
+    std::chrono::system_clock::time_point fetchedAt;
+};
+
+struct CacheStats {
+    long long hits;
+    long long misses;
+    long long stale;
+    long long refreshes;
+    long long evictions;
+    size_t    entries;
+    int       ttl_seconds;
+};
+
+class MarketCache {
+public:
+    MarketCache(std::chrono::seconds ttl, size_t maxPages);
+
+    CacheLookup lookup(const PageKey& key);
+    void        store(const PageKey& key, SkinPage page);
+
+    // Gives up a refresh claimed via lookup() when the upstream fetch failed,
+    // so the next reader can try again.
+    void releaseRefresh(const PageKey& key);
+
+    // Every cached page, for writing a snapshot.
+    std::vector<CachedPage> dump() const;
+
+    // Inserts a page loaded from a snapshot as if it had been fetched `age`
+    // ago, so pages past the TTL are served stale and refreshed on first
+    // read. Skipped if the page is already cached or the cache is full.
+    void restore(const PageKey& key, SkinPage page, std::chrono::seconds age);
+
+    // Bumped on every store; lets the snapshot writer skip unchanged caches.
+    long long generation() const { return generation_.load(); }
+
+    CacheStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using Lru   = std::list<std::string>;
+
+    struct Entry {
+        PageKey           key;
+        SkinPage          page;
+        Clock::time_point fetchedAt;
+        bool              refreshing = false;
+        Lru::iterator     lru;
+    };
+
+    void evictLocked();
+
+    std::chrono::seconds ttl_;
+    size_t               maxPages_;
+
+    mutable std::mutex                     mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    Lru                                    lru_;     // keys, most recent first
+
+    std::atomic<long long> hits_{0};
+    std::atomic<long long> misses_{0};
+    std::atomic<long long> stale_{0};
+    std::atomic<long long> refreshes_{0};
+    std::atomic<long long> evictions_{0};
+    std::atomic<long long> generation_{0};
+};
+
+// Shared instance, configured from SKIN_CACHE_TTL_SEC (default 300) and
+// SKIN_CACHE_MAX_PAGES (default 4096).
+MarketCache& marketCache();
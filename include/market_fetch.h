@@ -0,0 +1,138 @@
+#pragma once
+
+#include "catalog_warmer.h"
+#include "http_client.h"
+#include "market_cache.h"
+#include "skin.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// ─── Steam Market Fetch ────────────────────────────────────
+//
+// Loads Steam market search pages through the market cache: cached pages
+// are served from memory, stale ones refresh in the background, and missing
+// ones are fetched concurrently (identical in-flight pages are shared),
+// parsed, cached and added to the search index.
+
+// Steam host every upstream URL is built on, from SKIN_STEAM_BASE_URL
+// (default https://steamcommunity.com). Point it at a mock server to load
+// test without touching Steam.
+const std::string& steamBaseURL();
+
+std::string searchPageURL(const PageKey& key);
+
+// priceoverview URL for one market hash name.
+std::string priceOverviewURL(const std::string& hashName);
+
+// Parses one page of Steam market results, unfiltered apart from dropping
+// malformed and unpriced items. Returns nullopt when the body is not a
+// search result (Steam sometimes answers 200 with an HTML error page), so
+// callers never cache an error as "no results".
+std::optional<std::vector<Skin>> parsePage(const PageKey& key, const std::string& raw);
+
+// Receives each page of a batch as soon as it is available: the page's
+// index in the batch and the parsed page (null if the fetch failed).
+using PageSink = std::function<void(size_t index, const SkinPage& page)>;
+
+// Called once every page of a batch is in, with the pages in key order.
+using PagesDone = std::function<void(std::vector<SkinPage> pages)>;
+
+// Fetches and parses several pages concurrently under the shared Steam
+// limiter, storing each successful page in the market cache, and returns
+// at once. Pages already being fetched by another request are shared
+// rather than re-fetched. Each page reaches `sink` as it arrives, then
+// `done` runs. Both run on whichever thread completed the page (the
+// upstream reactor, the leader of a shared page, or inline when nothing
+// had to wait), never concurrently with each other. `priority` is the
+// reactor queue the fetches wait in; an interactive batch that joins a
+// background fetch promotes it.
+void loadPagesAsync(const std::vector<PageKey>& keys, PageSink sink, PagesDone done,
+                    FetchPriority priority = FetchPriority::Interactive);
+
+// Blocking loadPages(): `sink` runs on the calling thread, in completion
+// order.
+std::vector<SkinPage> loadPages(const std::vector<PageKey>& keys, const PageSink& sink = nullptr,
+                                FetchPriority priority = FetchPriority::Interactive);
+
+// Refreshes a stale cache entry off the request thread, at background
+// priority. The cache has already marked the entry as refreshing, so at
+// most one runs per page.
+void refreshPageAsync(const PageKey& key);
+
+// Where the pages behind one query came from. A query is degraded when
+// some of its pages were served past the cache TTL or could not be had at
+// all, typically because Steam is throttling us; responses built from it
+// carry a stale marker (see markStale()).
+struct PageFreshness {
+    size_t fromSteam  = 0;     // fetched for this call
+    size_t stale      = 0;     // served from cache past the TTL
+    size_t missing    = 0;     // neither cached nor delivered by Steam
+    double ageSeconds = 0.0;   // oldest cached page served
+
+    bool degraded() const { return stale > 0 || missing > 0; }
+
+    void merge(const PageFreshness& other);
+};
+
+// Appends skins from `page` whose price is within range into `skins`,
+// deduplicating via `seen`.
+void appendPage(
+    const SkinPage&            page,
+    int                        min_cents,
+    int                        max_cents,
+    std::vector<Skin>&         skins,
+    std::unordered_set<StrId>& seen
+);
+
+// Visits every page of a query across two sort orders (popular + price).
+// Cached pages reach `sink` immediately; the rest are fetched concurrently,
+// paced by the process-wide Steam limiter, and delivered as they arrive.
+// `sink` (may be null) receives the page's position in the popular/price
+// interleave.
+PageFreshness visitQueryPages(const std::string& query, int pages, const PageSink& sink);
+
+// Asynchronous visitQueryPages(): returns at once and calls `done` once
+// every page is in. Threading as for loadPagesAsync().
+void visitQueryPagesAsync(
+    const std::string&                              query,
+    int                                             pages,
+    PageSink                                        sink,
+    std::function<void(const PageFreshness& pages)> done
+);
+
+// Fetches multiple pages for a query across two sort orders (popular +
+// price) and calls `done` with the skins in [min_cents, max_cents],
+// deduplicated. Results are merged in the original popular/price
+// interleave so dedup order is stable regardless of which page arrived
+// first. Threading as for loadPagesAsync().
+void fetchQuery(
+    const std::string&                                                      query,
+    int                                                                     pages,
+    int                                                                     min_cents,
+    int                                                                     max_cents,
+    std::function<void(std::vector<Skin> skins, const PageFreshness& pages)> done
+);
+
+// Re-fetches every page of `query` from Steam regardless of cache freshness,
+// so warm queries are replaced before they ever go stale. The fetches wait
+// in the reactor's background queue, so each page starts only while no
+// user request is waiting and the limiter has tokens to spare.
+WarmResult warmQuery(const std::string& query, int pages);
+
+// Page fetches that joined an identical in-flight request.
+long long coalescedPageFetches();
+
+// Transport used by loadPagesAsync(): starts fetching `urls` at `priority`
+// and reports each result through `onDone` as it completes, either before
+// returning or later from another thread (a transport that calls back later
+// must copy `onDone`). Defaults to fetchAsync() on the upstream reactor;
+// the benchmarks install a stub serving recorded responses. Must be set
+// before any request is served.
+using PageTransport = std::function<void(const std::vector<std::string>& urls, FetchPriority priority,
+                                         const FetchDone& onDone)>;
+
+void setPageTransport(PageTransport transport);
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ─── Metrics ───────────────────────────────────────────────
+//
+// Counters and latency histograms rendered as Prometheus text by /metrics.
+// Every series is striped across cache-line-sized slots and each thread
+// updates its own slot, so recording is a relaxed atomic add on an
+// uncontended line and never takes a lock. Scrapes sum the slots.
+//
+// Series are registered once, under a lock, and callers keep the returned
+// reference (typically in a function-local static); the registry owns them
+// for the life of the process.
+
+constexpr size_t METRIC_STRIPES = 16;
+
+size_t nextMetricStripe();
+
+// This thread's stripe, assigned round-robin on first use.
+inline size_t metricStripe() {
+    thread_local size_t stripe = nextMetricStripe();
+    return stripe;
+}
+
+class Counter {
+public:
+    void     inc(uint64_t n = 1) { slots_[metricStripe()].v.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> v{0};
+    };
+    std::array<Slot, METRIC_STRIPES> slots_;
+};
+
+// Durations in fixed 1-2-5 log buckets from 10µs to 50s (Prometheus
+// "le" bounds), plus the overflow bucket.
+class Histogram {
+public:
+    static constexpr size_t BUCKETS = 21;
+    static const double     BOUNDS[BUCKETS];   // upper bounds, seconds
+
+    void observe(double seconds);
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS + 1> counts{};   // per bucket, not cumulative
+        uint64_t                          count = 0;
+        double                            sum   = 0.0; // seconds
+    };
+    Snapshot snapshot() const;
+
+private:
+    struct alignas(64) Stripe {
+        std::array<std::atomic<uint64_t>, BUCKETS + 1> counts{};
+        std::atomic<uint64_t>                          sumNs{0};
+    };
+    std::array<Stripe, METRIC_STRIPES> stripes_;
+};
+
+// Counters for one series family split by status code, e.g.
+// upstream_responses_total{endpoint="search",code="429"}. Each code's
+// counter is registered on first use and then found without locking.
+class CodeCounters {
+public:
+    CodeCounters(std::string name, std::string help, std::string labels);
+
+    // Codes outside 0..599 are counted as 0.
+    void inc(int code);
+
+private:
+    std::string                          name_;
+    std::string                          help_;
+    std::string                          labels_;
+    std::array<std::atomic<Counter*>, 600> codes_{};
+};
+
+class MetricsRegistry {
+public:
+    // `labels` is the inner label list, e.g. route="/search",code="200".
+    // Registering the same name and labels again returns the same series.
+    Counter&   counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    // A counter of nanoseconds exposed in seconds (e.g. busy time).
+    Counter& secondsCounter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    // Evaluated at scrape time.
+    void gauge(const std::string& name, const std::string& help, const std::string& labels,
+               std::function<double()> read);
+
+    std::string render();
+
+private:
+    enum class Kind { Counter, Histogram, Gauge };
+
+    struct Series {
+        std::string                labels;
+        std::unique_ptr<Counter>   counter;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()>    gauge;
+        double                     scale = 1.0;
+    };
+
+    struct Family {
+        std::string         help;
+        Kind                kind;
+        std::vector<Series> series;
+    };
+
+    Series& seriesLocked(const std::string& name, const std::string& help, Kind kind,
+                         const std::string& labels);
+
+    std::mutex                    mutex_;
+    std::map<std::string, Family> families_;
+};
+
+// Shared registry.
+MetricsRegistry& metrics();
+
+// Seconds elapsed since `began`, for Histogram::observe().
+inline double secondsSince(std::chrono::steady_clock::time_point began) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// ─── Price Cache ───────────────────────────────────────────
+//
+// priceoverview results keyed by market hash name. Unlike search pages,
+// prices are only served while fresh: an expired entry counts as a miss
+// and is fetched again. The expired quote stays available as a fallback
+// for when Steam cannot be reached. Entries are evicted least-recently-used
+// once the entry limit is reached.
+
+struct PriceQuote {
+    std::string                           lowest;   // "N/A" when Steam lists none
+    std::string                           median;
+    std::string                           volume;
+    std::chrono::system_clock::time_point fetchedAt;
+};
+
+using PriceQuotePtr = std::shared_ptr<const PriceQuote>;
+
+struct PriceCacheStats {
+    long long hits;
+    long long misses;
+    size_t    entries;
+    int       ttl_seconds;
+};
+
+class PriceCache {
+public:
+    PriceCache(std::chrono::seconds ttl, size_t maxEntries);
+
+    // Null when the name is not cached or its quote has expired.
+    PriceQuotePtr find(const std::string& name);
+
+    // The cached quote whatever its age, or null. Not counted as a lookup.
+    PriceQuotePtr findAny(const std::string& name);
+
+    void insert(const std::string& name, PriceQuotePtr quote);
+
+    PriceCacheStats stats() const;
+
+private:
+    using Lru = std::list<std::pair<std::string, PriceQuotePtr>>;
+
+    std::chrono::seconds ttl_;
+    size_t               maxEntries_;
+
+    mutable std::mutex                             mutex_;
+    Lru                                            lru_;     // most recent first
+    std::unordered_map<std::string, Lru::iterator> index_;
+
+    std::atomic<long long> hits_{0};
+    std::atomic<long long> misses_{0};
+};
+
+// Shared instance: SKIN_PRICE_TTL_SEC (default 300), SKIN_PRICE_CACHE_MAX
+// entries (default 50000).
+PriceCache& priceCache();
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "http_client.h"
+#include "price_cache.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// ─── Price Fetch ───────────────────────────────────────────
+//
+// priceoverview lookups for many hash names at once. Names are
+// deduplicated, fresh quotes come from the price cache, and the rest are
+// fetched under the shared Steam limiter, at most SKIN_PRICE_BATCH_WINDOW
+// (default 16) at a time so a large batch queues here rather than in the
+// upstream reactor. A name another request is already fetching is waited
+// on rather than fetched twice.
+// When Steam fails or is refusing requests, an expired quote is served
+// instead, marked stale.
+
+// The outcome for one name: a quote, or an error explaining why not.
+struct PriceResult {
+    std::string   name;
+    PriceQuotePtr quote;    // null on failure
+    std::string   error;
+    bool          cached = false;
+    bool          stale  = false;   // an expired quote standing in for a failed fetch
+};
+
+struct PriceBatchStats {
+    int unique  = 0;
+    int cached  = 0;
+    int fetched = 0;   // from Steam by this call
+    int shared  = 0;   // joined another request's fetch
+    int stale   = 0;   // expired quotes served because the fetch failed
+    int failed  = 0;
+};
+
+// Receives each name's result as soon as it is known: cached names first,
+// then fetched names in completion order.
+using PriceSink = std::function<void(const PriceResult& result)>;
+
+// Starts the lookups and returns at once; `done` runs after the last
+// result. Cached results reach `sink` on the calling thread, the rest on
+// the upstream reactor (or the thread of a shared fetch's leader). Calls
+// to `sink` and `done` never overlap. `priority` is the reactor queue the
+// Steam fetches wait in.
+void fetchPrices(
+    const std::vector<std::string>&            names,
+    PriceSink                                  sink,
+    std::function<void(PriceBatchStats stats)> done,
+    FetchPriority                              priority = FetchPriority::Interactive
+);
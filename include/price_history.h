@@ -0,0 +1,162 @@
+#pragma once
+
+#include "skin.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ─── Price History ─────────────────────────────────────────
+//
+// Time series of every observed (price_cents, listings) per hash name,
+// fed by parsed search pages and /price quotes. Samples closer together
+// than the resolution are dropped, and an unchanged price is only
+// re-recorded once per heartbeat, so a quiet item costs a handful of
+// samples a day.
+//
+// Each item's samples live in a list of small chunks. A chunk stores
+// (dt, dprice, dlistings) from the previous sample as zigzag varints, so a
+// typical sample takes 3-5 bytes; once an item has `chunksPerItem` full
+// chunks its oldest chunk is dropped. Chunk buffers start small and double
+// up to CHUNK_BYTES, so the long tail of rarely seen items stays cheap.
+//
+// Accepted samples can also be appended to a file (see HistoryWriter):
+//
+//   HistoryBlockHeader                      magic, counts, payload checksum
+//   varint len + bytes [names]              block-local name table
+//   varint name, t, price, listings [records]  t delta-coded, the rest zigzag
+//
+// Loading replays every intact block and truncates a torn tail. Whenever
+// the file holds more than twice the samples kept in memory (at load or
+// after an append) it is rewritten from memory.
+
+struct HistoryConfig {
+    std::chrono::seconds resolution;      // minimum spacing between samples
+    std::chrono::seconds heartbeat;       // re-record an unchanged price this often
+    size_t               chunksPerItem;
+};
+
+// One `step`-wide bucket of a downsampled series. Prices in cents.
+struct HistoryPoint {
+    int64_t t;          // bucket start, unix seconds
+    int     open;
+    int     low;
+    int     high;
+    int     close;
+    int     listings;   // as of the last sample in the bucket
+    int     samples;
+};
+
+struct HistoryStats {
+    size_t items;
+    size_t samples;     // held in memory, after dropped chunks
+    size_t bytes;       // memory held: buffers at capacity plus per-item overhead
+};
+
+class PriceHistory {
+public:
+    explicit PriceHistory(HistoryConfig config);
+
+    // Records one observation at `t` (unix seconds). `listings` < 0 means
+    // unknown and repeats the item's last known count. Samples older than
+    // the item's latest are ignored.
+    void record(StrId hashName, int priceCents, int listings, int64_t t);
+
+    void recordPage(const std::vector<Skin>& page, int64_t t);
+
+    // Samples in [from, to) grouped into `step`-second buckets; buckets
+    // without samples are omitted.
+    std::vector<HistoryPoint> query(StrId hashName, int64_t from, int64_t to, int64_t step) const;
+
+    HistoryStats stats() const;
+
+    // Replays `path` into the store and starts queueing new samples for
+    // appendPending(). Returns the number of samples read.
+    size_t load(const std::string& path);
+
+    // Appends samples accepted since the last call to `path`, compacting
+    // the file if it has grown past twice what memory keeps. Called from
+    // one thread at a time.
+    bool appendPending(const std::string& path);
+
+private:
+    static constexpr size_t SHARDS      = 16;
+    static constexpr size_t CHUNK_BYTES = 256;
+
+    struct Chunk {
+        int64_t     firstT  = 0;
+        int64_t     lastT   = 0;
+        uint32_t    samples = 0;
+        std::string bytes;          // records relative to (firstT, 0, 0)
+    };
+
+    // A vector rather than a deque: an empty deque already allocates a
+    // 512-byte block, more than most items ever record
+    struct Series {
+        std::vector<Chunk> chunks;
+        int64_t            lastT        = 0;
+        int                lastPrice    = 0;
+        int                lastListings = 0;
+    };
+
+    struct Shard {
+        mutable std::mutex                 mutex;
+        std::unordered_map<StrId, Series>  series;
+    };
+
+    struct Sample {
+        StrId   name;
+        int64_t t;
+        int     price;
+        int     listings;
+    };
+
+    Series& seriesLocked(Shard& shard, StrId hashName);
+    bool    recordLocked(Series& s, int priceCents, int listings, int64_t t);
+    bool    compact(const std::string& path);
+
+    HistoryConfig                config_;
+    std::array<Shard, SHARDS>    shards_;
+    std::atomic<size_t>          samples_{0};
+    std::atomic<size_t>          bytes_{0};
+
+    std::mutex                   pendingMutex_;
+    std::vector<Sample>          pending_;
+    std::atomic<bool>            persisting_{false};
+    size_t                       fileSamples_ = 0;   // records in the file; load/append thread only
+};
+
+// Shared store: SKIN_HISTORY_RESOLUTION_SEC (default 60),
+// SKIN_HISTORY_HEARTBEAT_SEC (default 21600), SKIN_HISTORY_CHUNKS per item
+// (default 64).
+PriceHistory& priceHistory();
+
+// Background thread that appends new samples to the history file every
+// `interval`, plus once more on stop().
+class HistoryWriter {
+public:
+    HistoryWriter(PriceHistory& history, std::string path, std::chrono::seconds interval);
+    ~HistoryWriter();
+
+    void start();
+    void stop();
+
+private:
+    void run();
+
+    PriceHistory&        history_;
+    std::string          path_;
+    std::chrono::seconds interval_;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    bool                    stopping_ = false;
+    std::thread             thread_;
+};
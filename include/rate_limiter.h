@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+// ─── Token Bucket Rate Limiter ─────────────────────────────
+//
+// One bucket is shared by every Crow worker, so the rate Steam sees is a
+// process-wide budget no matter how many requests are running. Tokens
+// refill continuously at one per `interval`; up to `burst` may accumulate
+// while the server is idle.
+//
+// The interval adapts to how Steam answers (AIMD): every throttled
+// response halves the rate, down to one token per `maxInterval`, and
+// every success wins back a sixteenth of the configured rate.
+
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TokenBucket(std::chrono::milliseconds interval, int burst, std::chrono::milliseconds maxInterval);
+
+    // Takes a token if one is available right now.
+    bool tryAcquire();
+
+    // Time until the next token becomes available (zero if one is ready).
+    std::chrono::milliseconds timeUntilNext();
+
+    // Tokens currently in the bucket, for background work that should only
+    // spend budget user requests are not using.
+    double available();
+
+    // A 429: halves the rate (once per interval, however many transfers
+    // were throttled together) and empties the bucket. With a Retry-After
+    // no token is issued before it has passed.
+    void throttled(std::chrono::seconds retryAfter);
+
+    // A response Steam did not throttle: additive step back toward the
+    // configured rate.
+    void succeeded();
+
+    // Current refill interval.
+    std::chrono::milliseconds interval();
+    int                       burst() const { return burst_; }
+
+private:
+    void refillLocked(Clock::time_point now);
+
+    const double base_;          // configured interval, ms
+    const double max_;           // slowest interval, ms
+    int          burst_;
+
+    std::mutex        mutex_;
+    double            interval_;     // ms
+    double            tokens_;
+    Clock::time_point last_;
+    Clock::time_point pausedUntil_;
+    Clock::time_point lastBackoff_;
+};
+
+// Shared Steam limiter, configured from STEAM_RATE_LIMIT_MS (default 150),
+// STEAM_RATE_BURST (default 10) and STEAM_RATE_MAX_MS (default 10000), the
+// slowest pace backoff may reach.
+TokenBucket& steamLimiter();
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// ─── Response Cache ────────────────────────────────────────
+//
+// Finished JSON bodies for deterministic requests, stored together with a
+// strong ETag and a gzip copy so a repeat request costs neither
+// serialization nor compression. Keys must include a fingerprint of every
+// input the body depends on (query, parameters, the skins it was built
+// from); entries are never invalidated, only evicted least-recently-used
+// once the byte budget is reached.
+
+struct CachedBody {
+    std::string body;
+    std::string gzip;       // empty when compression would not help
+    std::string etag;       // quoted, for the identity body
+    std::string gzipEtag;   // quoted, for the gzip body
+};
+
+using CachedBodyPtr = std::shared_ptr<const CachedBody>;
+
+struct ResponseCacheStats {
+    long long hits;
+    long long misses;
+    long long notModified;
+    size_t    entries;
+    size_t    bytes;
+};
+
+class ResponseCache {
+public:
+    explicit ResponseCache(size_t maxBytes);
+
+    CachedBodyPtr find(const std::string& key);
+
+    // Compresses `body`, stores it under `key` and returns the entry.
+    CachedBodyPtr insert(const std::string& key, std::string body);
+
+    void               countNotModified() { notModified_++; }
+    ResponseCacheStats stats() const;
+
+private:
+    using Lru = std::list<std::pair<std::string, CachedBodyPtr>>;
+
+    static size_t footprint(const Lru::value_type& e);
+
+    size_t maxBytes_;
+
+    mutable std::mutex                             mutex_;
+    Lru                                            lru_;     // most recent first
+    std::unordered_map<std::string, Lru::iterator> index_;
+    size_t                                         bytes_ = 0;
+
+    std::atomic<long long> hits_{0};
+    std::atomic<long long> misses_{0};
+    std::atomic<long long> notModified_{0};
+};
+
+// Builds a CachedBody without storing it, for responses that cannot be
+// reused (e.g. ones carrying timings).
+CachedBody makeBody(std::string body, int level);
+
+// gzip (RFC 1952) at zlib `level`. Returns "" on failure.
+std::string gzipCompress(const std::string& data, int level);
+
+// True if an Accept-Encoding header allows gzip (q=0 excluded).
+bool acceptsGzip(const std::string& acceptEncoding);
+
+// True if an If-None-Match header lists `etag` or "*". Weak comparison, as
+// RFC 9110 prescribes for If-None-Match.
+bool etagMatches(const std::string& ifNoneMatch, const std::string& etag);
+
+// Shared instance, sized from SKIN_RESPONSE_CACHE_MB (default 32).
+ResponseCache& responseCache();
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "crow_all.h"
+#include "market_fetch.h"
+#include "price_fetch.h"
+#include "response_cache.h"
+#include "skin.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// ─── API Responses ─────────────────────────────────────────
+//
+// JSON shapes shared by the routes, and the encoding every JSON response
+// goes through: strong ETag, gzip when the client accepts it, and 304 for
+// matching revalidations of GET routes.
+
+// Converts a Skin struct to a crow JSON value for API responses.
+crow::json::wvalue skinToJson(const Skin& s);
+
+// Converts a Skin to the compact option shape used by the optimizer and
+// loadout responses.
+crow::json::wvalue skinToOptionJson(const Skin& s);
+
+// One /price or /price/batch result: the quote with its fetch time, or
+// the name and an inline error.
+crow::json::wvalue priceToJson(const PriceResult& r);
+
+// Hex digest of everything a skin list contributes to a response, for
+// response cache keys. Interned ids stand in for their strings.
+std::string skinsFingerprint(const std::vector<Skin>& skins);
+
+// Sends a prepared JSON body, gzipped when the client accepts it. When
+// `revalidate` is set (GET routes) a matching If-None-Match gets a bodiless
+// 304 instead.
+crow::response sendBody(const crow::request& req, const CachedBody& b, bool revalidate);
+
+// Serves a deterministic response from the response cache, building and
+// storing it on a miss. `key` must identify every input of `build`.
+crow::response sendCached(
+    const crow::request&                       req,
+    const std::string&                         key,
+    const std::function<crow::json::wvalue()>& build
+);
+
+// Marks a response built from degraded pages: `stale`, how many pages
+// Steam failed to deliver and the age of the oldest expired page used.
+// Leaves fresh responses untouched.
+void markStale(crow::json::wvalue& r, const PageFreshness& pages);
+
+// sendCached() for responses built from market pages. Degraded responses
+// are marked stale and built per request instead, so the response cache
+// never serves them once Steam recovers.
+crow::response sendPages(
+    const crow::request&                       req,
+    const std::string&                         key,
+    const PageFreshness&                       pages,
+    const std::function<crow::json::wvalue()>& build
+);
+
+// Sends a one-off response (e.g. one carrying timings) with the same
+// encoding rules, without caching it.
+crow::response sendJson(const crow::request& req, crow::json::wvalue& value);
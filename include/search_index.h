@@ -0,0 +1,137 @@
+#pragma once
+
+#include "market_cache.h"
+#include "skin.h"
+
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ─── Search Index ──────────────────────────────────────────
+//
+// In-process inverted index over every skin the server has parsed, so
+// /search can answer from memory once a query's pages are cached.
+//
+// Names are split into lowercase alphanumeric tokens ("AK-47 | Redline
+// (Field-Tested)" -> ak, 47, redline, field, tested). Each token's posting
+// list is kept sorted by price, so a price window is two binary searches
+// and a multi-word query intersects the narrowed lists. The last query word
+// also matches as a prefix ("redl" finds "redline").
+//
+// Skins are keyed by hash_name; a later page with the same skin updates its
+// price and listings in place. Skins no page has returned within the max
+// age are dropped, with their postings, a few times per max age as pages
+// arrive, so the index stays the size of what Steam is still listing.
+//
+// Each doc's attributes (weapon, wear, StatTrak, ...) are also packed into
+// one 64-bit word in an array beside the docs, so attribute filters cost a
+// mask-and-compare per candidate before any skin is copied.
+
+// Price filters on /search are clamped to this many dollars, the cap the
+// budget routes use.
+constexpr double SEARCH_MAX_PRICE = 10000.0;
+
+// Attribute filters for search(). Defaults match everything.
+struct SearchFilter {
+    int         min_cents = 0;
+    int         max_cents = INT_MAX;
+    uint32_t    wears     = 0;    // bits 1 << Wear; 0 = any wear
+    int         stattrak  = -1;   // 1 only StatTrak, 0 no StatTrak, -1 either
+    std::string weapon;           // case-insensitive; empty = any
+
+    // The same test for a skin outside the index (streamed pages).
+    bool matches(const Skin& s) const;
+};
+
+// SearchFilter::wears bits for a comma-separated list of wear keys or
+// names ("fn,mw", "Field-Tested"). Sets `error` on an unknown entry.
+uint32_t parseWearList(std::string_view list, std::string* error);
+
+struct SearchIndexStats {
+    size_t items;
+    size_t terms;
+    size_t postings;
+};
+
+class SearchIndex {
+public:
+    // Skins not seen on any page within `maxAge` are left out of results
+    // and later removed.
+    explicit SearchIndex(std::chrono::seconds maxAge);
+
+    // Indexes a page Steam returned for `query`. The query's words are
+    // attached to each skin as well, since Steam matches on more than the
+    // name ("Knife" returns "★ Karambit").
+    void add(const std::vector<Skin>& page, const std::string& query);
+
+    // Bulk form for a restored cache; sorts each posting list once.
+    void add(const std::vector<CachedPage>& pages);
+
+    // Bulk form for pages of one query served from the cache (null pages
+    // are skipped). Re-adding a cached page the index may have expired
+    // keeps its skins searchable for as long as the cache serves it.
+    void add(const std::vector<SkinPage>& pages, const std::string& query);
+
+    std::chrono::seconds maxAge() const { return maxAge_; }
+
+    // Skins matching every word of `query` and `filter`, most expensive
+    // first.
+    std::vector<Skin> search(const std::string& query, const SearchFilter& filter) const;
+
+    SearchIndexStats stats() const;
+
+    static std::vector<std::string> tokenize(const std::string& text);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Posting {
+        int      price;
+        uint32_t doc;
+
+        bool operator<(const Posting& o) const {
+            return price != o.price ? price < o.price : doc < o.doc;
+        }
+        bool operator==(const Posting& o) const { return price == o.price && doc == o.doc; }
+    };
+
+    using Postings = std::vector<Posting>;
+
+    struct Doc {
+        Skin                     skin;
+        std::vector<std::string> tokens;
+        Clock::time_point        updatedAt;
+    };
+
+    void addPageLocked(const std::vector<Skin>& page, const std::string& query, Clock::time_point now);
+    void flushLocked();
+    void pruneLocked(Clock::time_point now);
+    void addLocked(const Skin& s, const std::vector<std::string>& queryTokens, Clock::time_point now);
+    void insertLocked(const std::string& token, Posting p);
+    void removeLocked(Postings& list, Posting p);
+    void matchLocked(const std::string& token, bool prefix, int min_cents, int max_cents,
+                     Postings& out) const;
+
+    std::chrono::seconds maxAge_;
+
+    mutable std::shared_mutex                 mutex_;
+    std::vector<Doc>                          docs_;
+    std::vector<uint64_t>                     attrs_;   // packed, by doc
+    std::unordered_map<StrId, uint32_t>       byHash_;
+    std::map<std::string, Postings>           terms_;   // ordered for prefix scans
+    size_t                                    postings_ = 0;
+    Clock::time_point                         lastPrune_;
+
+    // Lists with postings appended since the last flush, mapped to their
+    // sorted length before them
+    std::unordered_map<Postings*, size_t>     pending_;
+};
+
+// Shared instance; SKIN_INDEX_MAX_AGE_SEC (default 3600) bounds how long a
+// skin that stopped appearing on Steam pages stays searchable.
+SearchIndex& searchIndex();
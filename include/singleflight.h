@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ─── Singleflight ──────────────────────────────────────────
+//
+// Coalesces identical in-flight work. The first caller to joinOrWait() a
+// key becomes its leader and must call finish(); everyone who joins the
+// same key before then becomes a follower and registers a callback that
+// the leader's finish() runs on its own thread, instead of repeating the
+// work. The key is forgotten once finished, so a later call starts a fresh
+// flight.
+//
+// A null result means the leader's work failed; followers see the same.
+
+template <typename T>
+class SingleFlight {
+public:
+    using Result = std::shared_ptr<const T>;
+    using Waiter = std::function<void(const Result&)>;
+
+    // Returns true if the caller leads. Otherwise `waiter` is called with
+    // the leader's result once it finishes.
+    bool joinOrWait(const std::string& key, Waiter waiter) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = inflight_.find(key);
+        if (it != inflight_.end()) {
+            followers_++;
+            it->second.waiters.push_back(std::move(waiter));
+            return false;
+        }
+
+        inflight_[key];
+        leaders_++;
+        return true;
+    }
+
+    void finish(const std::string& key, Result value) {
+        std::vector<Waiter> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = inflight_.find(key);
+            if (it == inflight_.end()) return;
+            waiters = std::move(it->second.waiters);
+            inflight_.erase(it);
+        }
+        for (auto& w : waiters)
+            w(value);
+    }
+
+    long long leaders() const   { return leaders_.load(); }
+    long long followers() const { return followers_.load(); }
+
+private:
+    struct Flight {
+        std::vector<Waiter> waiters;
+    };
+
+    std::mutex                              mutex_;
+    std::unordered_map<std::string, Flight> inflight_;
+
+    std::atomic<long long> leaders_{0};
+    std::atomic<long long> followers_{0};
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// ─── Interned Strings ──────────────────────────────────────
+//
+// Names, price texts and icon paths repeat across pages, sort orders and
+// queries, so each distinct string is stored once in a process-wide pool
+// and skins hold 32-bit ids. Interned strings live for the whole process;
+// the pool grows only with the number of distinct catalog strings.
+
+using StrId = uint32_t;   // 0 is always the empty string
+
+StrId            intern(std::string_view s);
+std::string_view interned(StrId id);
+
+// Id of an already interned string, or 0 if it was never interned. Unlike
+// intern() this never grows the pool, so it is safe for user input.
+StrId findInterned(std::string_view s);
+
+struct InternStats {
+    size_t strings;
+    size_t bytes;
+};
+
+InternStats internStats();
+
+// ─── Skin Struct ───────────────────────────────────────────
+//
+// icon_url and market_url are not stored: both are a constant prefix plus
+// a per-skin suffix, and are built only when a response is written.
+//
+// The attributes after `listings` are parsed from the market hash name
+// once, when the skin is ingested (parseItemAttributes()), so filters and
+// responses never re-parse names:
+//
+//   "★ StatTrak™ Karambit | Doppler (Factory New)"
+//     -> weapon "Karambit", finish "Doppler", FactoryNew, StatTrak, Knife
+
+enum class Wear : uint8_t { None, FactoryNew, MinimalWear, FieldTested, WellWorn, BattleScarred };
+
+enum class ItemCategory : uint8_t { Weapon, Knife, Gloves, Other };
+
+constexpr uint8_t SKIN_STATTRAK = 1;
+constexpr uint8_t SKIN_SOUVENIR = 2;
+
+struct Skin {
+    StrId        name;
+    StrId        hash_name;
+    StrId        price_text;
+    StrId        sale_price_text;
+    StrId        icon;          // icon_url after ICON_URL_PREFIX
+    int          price_cents;
+    int          listings;
+    StrId        weapon   = 0;  // "AK-47", "Karambit", "Sticker"
+    StrId        finish   = 0;  // "Redline"; 0 for vanilla knives and cases
+    Wear         wear     = Wear::None;
+    ItemCategory category = ItemCategory::Other;
+    uint8_t      flags    = 0;  // SKIN_STATTRAK, SKIN_SOUVENIR
+};
+
+// Fills weapon, finish, wear, category and flags from the hash name.
+void parseItemAttributes(Skin& s);
+
+// Short wear key ("fn", "mw", "ft", "ww", "bs"); "" for Wear::None.
+const char* wearKey(Wear w);
+
+// Wear for a short key or full name ("ft", "Field-Tested"), case-
+// insensitively. Wear::None when it is neither.
+Wear parseWear(std::string_view text);
+
+// "weapon", "knife", "gloves" or "other".
+const char* categoryName(ItemCategory c);
+
+constexpr const char* ICON_URL_PREFIX   = "https://community.akamai.steamstatic.com/economy/image/";
+constexpr const char* MARKET_URL_PREFIX = "https://steamcommunity.com/market/listings/730/";
+
+std::string iconURL(const Skin& s);
+std::string marketURL(const Skin& s);
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "crow_all.h"
+#include "catalog_warmer.h"
+#include "market_fetch.h"
+#include "skin.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+// ─── Loadout Slot Fetcher ──────────────────────────────────
+//
+// Candidate skins for /loadout/build: each slot (primary, secondary, knife,
+// gloves) searches a few weapon queries concurrently through the upstream
+// reactor, and the slot's options are interleaved across weapons.
+
+// Weapon queries searched for each slot, per side.
+void sideQueries(
+    const std::string&        side,
+    std::vector<std::string>& primary,
+    std::vector<std::string>& secondary
+);
+
+// One slot to fetch: its weapon queries and the price cap for each.
+struct SlotRequest {
+    std::vector<std::string> queries;
+    int                      budget_cents;
+};
+
+// A slot's fetched weapon sub-queries, in query order.
+struct SlotFetch {
+    using Clock = std::chrono::steady_clock;
+
+    struct Weapon {
+        std::vector<Skin> skins;      // sorted by price descending
+        PageFreshness     pages;
+        Clock::time_point finished;
+    };
+
+    Clock::time_point   started;
+    std::vector<Weapon> weapons;
+};
+
+// Starts one fetchQuery() per weapon query of every slot at once, so all of
+// a request's sub-queries are in flight together under the shared Steam
+// limiter. `done` receives the slots in request order on the thread that
+// finished the last query.
+void fetchSlots(
+    const std::vector<SlotRequest>&                   slots,
+    std::function<void(std::vector<SlotFetch> slots)> done
+);
+
+// A slot's weapon lists with each skin kept only under the first weapon (in
+// query order) that returned it; weapons left empty are dropped.
+// `elapsed_ms` receives the time until the slowest weapon query finished.
+std::vector<std::vector<Skin>> finishSlotFetch(const SlotFetch& slot, double* elapsed_ms = nullptr);
+
+// Page freshness merged across every weapon query of every slot.
+PageFreshness slotFreshness(const std::vector<SlotFetch>& slots);
+
+// Takes the best result from each weapon, then fills remaining slots
+// round-robin with next-best across all weapons.
+// This ensures variety — e.g. one AK-47, one SG 553, one Galil AR — rather than
+// all slots going to whichever weapon has the most cheap listings.
+std::vector<crow::json::wvalue> interleaveOptions(
+    const std::vector<std::vector<Skin>>& perWeapon,
+    int                                   max_options = 5
+);
+
+// The slots of a joint-mode loadout, each capped at the whole budget.
+std::vector<SlotRequest> jointSlots(
+    const std::string&        side,
+    int                       total_cents,
+    bool                      include_knife,
+    bool                      include_gloves,
+    std::vector<std::string>& slotNames
+);
+
+// Builds the top-k complete loadouts (one skin per slot) under a single
+// total budget, so money one slot leaves unspent can fund another.
+// `fetches` are the jointSlots() slots, fetched.
+crow::json::wvalue buildJointLoadouts(
+    const std::string&              side,
+    double                          total_budget,
+    int                             top_k,
+    const std::vector<std::string>& slotNames,
+    const std::vector<SlotFetch>&   fetches
+);
+
+// Pins the queries behind /loadout/build for both sides (3 pages each, as
+// fetchSlots() requests) plus any extra terms listed in the
+// comma-separated SKIN_WARM_QUERIES (10 pages each, as /search requests).
+void pinWarmSet(CatalogWarmer& warmer);
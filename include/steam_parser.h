@@ -0,0 +1,23 @@
+#pragma once
+
+#include "skin.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+// ─── Steam Search Response Parsing ─────────────────────────
+//
+// Turns one market/search/render?norender=1 response into skins, unfiltered
+// apart from dropping malformed and unpriced items. Both return nullopt
+// (with a reason in `error`) when the body is not a usable search
+// response, so callers never cache an error as "no results".
+
+// Streaming parse: a single forward pass that reads only the seven fields
+// a Skin needs and skips everything else (the rest of asset_description,
+// app_icon, searchdata) without building a DOM or copying it.
+std::optional<std::vector<Skin>> parseSearchPage(const std::string& raw, std::string* error = nullptr);
+
+// Reference implementation over a full nlohmann DOM; kept for the parse
+// benchmark.
+std::optional<std::vector<Skin>> parseSearchPageDom(const std::string& raw, std::string* error = nullptr);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ─── Precomputed Budget Table ──────────────────────────────
+//
+// Because an item's value equals its price, the budget optimizer is exact
+// subset-sum: the DP row is a bitset of reachable totals, and adding an
+// item is one word-parallel shift-or. A table holds that state for one
+// item set, built once and then queried for any budget. A single forward
+// pass to the largest budget already yields the best total for every
+// smaller one: the highest reachable total at or below it. The pass also
+// records, for every total, the item whose addition first made it
+// reachable. That total minus the item's weight was reachable from earlier
+// items alone, so following the links rebuilds a chosen set in
+// O(items chosen), with no backtracking recomputation.
+// Memory is 4 bytes per cent of the table's limit: 4 MB at $10,000.
+
+class SubsetSumTable {
+public:
+    // Covers budgets up to min(maxLimit, sum of the usable weights).
+    // Non-positive weights and weights above maxLimit are never chosen.
+    SubsetSumTable(const std::vector<int>& weights, int maxLimit);
+
+    // Largest reachable total <= capacity.
+    int best(int capacity) const;
+
+    // Indices into the weights of a subset summing to best(capacity).
+    std::vector<int> choose(int capacity) const;
+
+    int       limit() const { return limit_; }
+    long long total() const { return total_; }   // sum of the usable weights
+    long long cells() const { return cells_; }   // DP cells updated by the build
+    size_t    bytes() const;
+
+private:
+    std::vector<int>           weights_;
+    int                        limit_ = 0;
+    long long                  total_ = 0;
+    long long                  cells_ = 0;
+    std::vector<std::uint64_t> reach_;       // bitset of reachable totals
+    std::vector<std::int32_t>  firstItem_;   // per total; -1 if unreachable or 0
+};
@@ -0,0 +1,66 @@
+#include "budget_table.h"
+#include "config.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <chrono>
+
+BudgetTableCache::BudgetTableCache(size_t maxBytes) : maxBytes_(maxBytes) {}
+
+SubsetSumTablePtr BudgetTableCache::get(const std::string& key, const std::vector<Skin>& skins, bool* cached) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (cached) *cached = it != index_.end();
+        if (it != index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            hits_++;
+            return it->second->second;
+        }
+        misses_++;
+    }
+
+    static Histogram& buildLatency = metrics().histogram(
+        "cs_skin_optimizer_solve_duration_seconds", "Optimizer solve time",
+        "algorithm=\"budget_table\"");
+
+    // Build outside the lock; concurrent misses on one item set just race
+    // to store identical tables
+    std::vector<int> weights;
+    weights.reserve(skins.size());
+    for (const auto& s : skins)
+        weights.push_back(s.price_cents);
+
+    auto began = std::chrono::steady_clock::now();
+    auto table = std::make_shared<const SubsetSumTable>(weights, MAX_BUDGET_CENTS);
+    buildLatency.observe(secondsSince(began));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        bytes_ -= it->second->second->bytes();
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    lru_.emplace_front(key, table);
+    index_[key] = lru_.begin();
+    bytes_ += table->bytes();
+
+    while (bytes_ > maxBytes_ && lru_.size() > 1) {
+        bytes_ -= lru_.back().second->bytes();
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+    return table;
+}
+
+BudgetTableStats BudgetTableCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {hits_.load(), misses_.load(), index_.size(), bytes_};
+}
+
+BudgetTableCache& budgetTables() {
+    static BudgetTableCache cache(static_cast<size_t>(std::max(1, envInt("SKIN_BUDGET_TABLE_MB", 64))) << 20);
+    return cache;
+}
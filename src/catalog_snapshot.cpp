@@ -0,0 +1,412 @@
+#include "catalog_snapshot.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char     SNAPSHOT_MAGIC[8] = {'C', 'S', 'S', 'K', 'S', 'N', 'A', 'P'};
+constexpr uint32_t SNAPSHOT_VERSION  = 2;
+
+struct StrRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct SnapshotHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t pageCount;
+    uint64_t skinCount;
+    uint64_t arenaBytes;    // padded to a multiple of 8
+    uint64_t checksum;      // of everything after the header
+    int64_t  writtenAt;     // unix seconds
+};
+
+struct SnapshotPage {
+    int64_t  fetchedAt;     // unix seconds
+    StrRef   query;
+    StrRef   sortCol;
+    StrRef   sortDir;
+    int32_t  start;
+    uint32_t firstSkin;
+    uint32_t skinCount;
+    uint32_t reserved;
+};
+
+struct SnapshotSkin {
+    StrRef  name;
+    StrRef  hashName;
+    StrRef  priceText;
+    StrRef  salePriceText;
+    StrRef  icon;          // path after ICON_URL_PREFIX
+    int32_t priceCents;
+    int32_t listings;
+};
+
+static_assert(sizeof(SnapshotHeader) == 48, "snapshot header layout changed");
+static_assert(sizeof(SnapshotPage)   == 48, "snapshot page layout changed");
+static_assert(sizeof(SnapshotSkin)   == 48, "snapshot skin layout changed");
+
+// FNV-1a over 64-bit words rather than bytes; every section is 8-byte
+// aligned, so this runs at memory speed on a ~10 MB snapshot.
+uint64_t checksum(const char* data, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    size_t   i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        h = (h ^ w) * 0x100000001b3ULL;
+    }
+    for (; i < len; i++)
+        h = (h ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+    return h;
+}
+
+// Appends strings to the arena once each; pages sorted by price and by
+// popularity hold mostly the same skins.
+class ArenaBuilder {
+public:
+    bool add(std::string_view s, StrRef* ref) {
+        auto it = seen_.find(s);
+        if (it != seen_.end()) {
+            *ref = it->second;
+            return true;
+        }
+        if (bytes_.size() + s.size() > UINT32_MAX) return false;
+
+        *ref = {static_cast<uint32_t>(bytes_.size()), static_cast<uint32_t>(s.size())};
+        bytes_.append(s.data(), s.size());
+        seen_.emplace(s, *ref);
+        return true;
+    }
+
+    std::string& bytes() { return bytes_; }
+
+private:
+    std::string                                  bytes_;
+    std::unordered_map<std::string_view, StrRef> seen_;  // views into cached pages
+};
+
+// Read-only view of a whole file, memory-mapped where the platform allows.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) return;
+
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) return;
+
+        data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (data_) size_ = static_cast<size_t>(size.QuadPart);
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) return;
+
+        struct stat st;
+        if (::fstat(fd_, &st) != 0 || st.st_size == 0) return;
+
+        void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED) return;
+
+        data_ = static_cast<const char*>(p);
+        size_ = static_cast<size_t>(st.st_size);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data_)                       UnmapViewOfFile(data_);
+        if (mapping_)                    CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#else
+        if (data_)   ::munmap(const_cast<char*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t      size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t      size_ = 0;
+#ifdef _WIN32
+    HANDLE file_    = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+int64_t toUnix(std::chrono::system_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count();
+}
+
+double msSince(std::chrono::steady_clock::time_point began) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - began).count();
+}
+
+} // namespace
+
+bool writeSnapshot(const MarketCache& cache, const std::string& path, SnapshotInfo* info) {
+    auto began = std::chrono::steady_clock::now();
+    auto pages = cache.dump();
+
+    ArenaBuilder              arena;
+    std::vector<SnapshotPage> pageRecs;
+    std::vector<SnapshotSkin> skinRecs;
+    pageRecs.reserve(pages.size());
+
+    for (const auto& cp : pages) {
+        SnapshotPage pr{};
+        pr.fetchedAt = toUnix(cp.fetchedAt);
+        pr.start     = cp.key.start;
+        pr.firstSkin = static_cast<uint32_t>(skinRecs.size());
+        pr.skinCount = static_cast<uint32_t>(cp.page->size());
+
+        bool ok = arena.add(cp.key.query,   &pr.query)
+               && arena.add(cp.key.sortCol, &pr.sortCol)
+               && arena.add(cp.key.sortDir, &pr.sortDir);
+
+        for (const Skin& s : *cp.page) {
+            SnapshotSkin sr{};
+            ok = ok && arena.add(interned(s.name),            &sr.name)
+                    && arena.add(interned(s.hash_name),       &sr.hashName)
+                    && arena.add(interned(s.price_text),      &sr.priceText)
+                    && arena.add(interned(s.sale_price_text), &sr.salePriceText)
+                    && arena.add(interned(s.icon),            &sr.icon);
+            sr.priceCents = s.price_cents;
+            sr.listings   = s.listings;
+            skinRecs.push_back(sr);
+        }
+
+        if (!ok || skinRecs.size() > UINT32_MAX) {
+            LOG_WARN("snapshot") << "Catalog too large for snapshot format";
+            return false;
+        }
+        pageRecs.push_back(pr);
+    }
+
+    std::string& strings = arena.bytes();
+    strings.resize((strings.size() + 7) & ~size_t(7), '\0');
+
+    std::string body;
+    body.reserve(pageRecs.size() * sizeof(SnapshotPage) + skinRecs.size() * sizeof(SnapshotSkin) + strings.size());
+    body.append(reinterpret_cast<const char*>(pageRecs.data()), pageRecs.size() * sizeof(SnapshotPage));
+    body.append(reinterpret_cast<const char*>(skinRecs.data()), skinRecs.size() * sizeof(SnapshotSkin));
+    body.append(strings);
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version    = SNAPSHOT_VERSION;
+    header.pageCount  = static_cast<uint32_t>(pageRecs.size());
+    header.skinCount  = skinRecs.size();
+    header.arenaBytes = strings.size();
+    header.checksum   = checksum(body.data(), body.size());
+    header.writtenAt  = toUnix(std::chrono::system_clock::now());
+
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(body.data(), static_cast<std::streamsize>(body.size()));
+        if (!out) {
+            LOG_WARN("snapshot") << "Failed to write " << tmp;
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    // rename() will not replace an existing file on Windows
+    std::remove(path.c_str());
+#endif
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        LOG_WARN("snapshot") << "Failed to replace " << path;
+        std::remove(tmp.c_str());
+        return false;
+    }
+
+    if (info) *info = {pageRecs.size(), skinRecs.size(), sizeof(header) + body.size(), msSince(began)};
+    return true;
+}
+
+bool loadSnapshot(MarketCache& cache, const std::string& path,
+                  std::chrono::seconds maxAge, SnapshotInfo* info) {
+    auto began = std::chrono::steady_clock::now();
+
+    MappedFile file(path);
+    if (!file.data()) return false;
+
+    auto reject = [&](const char* why) {
+        LOG_WARN("snapshot") << "Ignoring " << path << ": " << why;
+        return false;
+    };
+
+    if (file.size() < sizeof(SnapshotHeader)) return reject("truncated header");
+
+    SnapshotHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+        return reject("not a snapshot");
+    if (header.version != SNAPSHOT_VERSION)
+        return reject("unsupported version");
+
+    // Sizes are checked against the file before multiplying, so a corrupt
+    // header cannot overflow the expected length.
+    size_t bodySize = file.size() - sizeof(SnapshotHeader);
+    if (header.pageCount > bodySize / sizeof(SnapshotPage) ||
+        header.skinCount > bodySize / sizeof(SnapshotSkin) ||
+        header.arenaBytes > bodySize)
+        return reject("bad section sizes");
+
+    size_t pagesBytes = header.pageCount * sizeof(SnapshotPage);
+    size_t skinsBytes = static_cast<size_t>(header.skinCount) * sizeof(SnapshotSkin);
+    if (pagesBytes + skinsBytes + header.arenaBytes != bodySize)
+        return reject("bad section sizes");
+
+    const char* body = file.data() + sizeof(SnapshotHeader);
+    if (checksum(body, bodySize) != header.checksum)
+        return reject("checksum mismatch");
+
+    // mmap returns page-aligned memory and every section is 8-byte aligned
+    auto        pageRecs   = reinterpret_cast<const SnapshotPage*>(body);
+    auto        skinRecs   = reinterpret_cast<const SnapshotSkin*>(body + pagesBytes);
+    const char* arena      = body + pagesBytes + skinsBytes;
+    uint64_t    arenaBytes = header.arenaBytes;
+
+    // The arena holds each string once, so its offset identifies it and
+    // each distinct string is hashed into the intern pool only once
+    std::unordered_map<uint32_t, StrId> ids;
+
+    bool bad  = false;
+    auto id   = [&](const StrRef& r) -> StrId {
+        if (static_cast<uint64_t>(r.offset) + r.length > arenaBytes) {
+            bad = true;
+            return 0;
+        }
+        auto it = ids.find(r.offset);
+        if (it != ids.end() && interned(it->second).size() == r.length) return it->second;
+        StrId v = intern(std::string_view(arena + r.offset, r.length));
+        ids[r.offset] = v;
+        return v;
+    };
+    auto str = [&](const StrRef& r) { return std::string(interned(id(r))); };
+
+    int64_t now = toUnix(std::chrono::system_clock::now());
+    size_t  pages = 0, items = 0;
+
+    for (uint32_t i = 0; i < header.pageCount; i++) {
+        const SnapshotPage& pr = pageRecs[i];
+        if (static_cast<uint64_t>(pr.firstSkin) + pr.skinCount > header.skinCount)
+            return reject("page out of range");
+
+        int64_t age = std::max<int64_t>(0, now - pr.fetchedAt);
+        if (age > maxAge.count()) continue;
+
+        PageKey key{str(pr.query), str(pr.sortCol), str(pr.sortDir), pr.start};
+
+        auto page = std::make_shared<std::vector<Skin>>();
+        page->reserve(pr.skinCount);
+        for (uint32_t j = 0; j < pr.skinCount; j++) {
+            const SnapshotSkin& sr = skinRecs[pr.firstSkin + j];
+            page->push_back({
+                id(sr.name),
+                id(sr.hashName),
+                id(sr.priceText),
+                id(sr.salePriceText),
+                id(sr.icon),
+                sr.priceCents,
+                sr.listings
+            });
+            parseItemAttributes(page->back());
+        }
+        if (bad) return reject("string out of range");
+
+        cache.restore(key, std::move(page), std::chrono::seconds(age));
+        pages++;
+        items += pr.skinCount;
+    }
+
+    if (info) *info = {pages, items, file.size(), msSince(began)};
+    return true;
+}
+
+SnapshotWriter::SnapshotWriter(MarketCache& cache, std::string path, std::chrono::seconds interval)
+    : cache_(cache), path_(std::move(path)), interval_(interval) {
+    // A freshly restored cache matches the file already on disk
+    written_ = cache_.generation();
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    stop();
+}
+
+void SnapshotWriter::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) return;
+    stopping_ = false;
+    thread_   = std::thread([this]() { run(); });
+}
+
+void SnapshotWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!thread_.joinable()) return;
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+    writeIfChanged();
+}
+
+void SnapshotWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (wake_.wait_for(lock, interval_, [this]() { return stopping_; }))
+            break;
+        lock.unlock();
+        writeIfChanged();
+        lock.lock();
+    }
+}
+
+void SnapshotWriter::writeIfChanged() {
+    long long gen = cache_.generation();
+    if (gen == written_) return;
+
+    SnapshotInfo info;
+    if (!writeSnapshot(cache_, path_, &info)) return;
+    written_ = gen;
+
+    LOG_INFO("snapshot") << "Wrote " << info.pages << " pages, " << info.items << " items ("
+                         << info.bytes << " bytes) in " << info.ms << "ms";
+}
@@ -0,0 +1,219 @@
+#include "catalog_warmer.h"
+#include "config.h"
+#include "log.h"
+#include "rate_limiter.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Non-pinned queries tracked for request frequency; the coldest are dropped
+// beyond this so arbitrary search terms cannot grow the map without bound.
+static constexpr size_t MAX_TRACKED_QUERIES = 4096;
+
+// Minimum decayed request count before a /search term is worth warming.
+static constexpr double MIN_HOT_SCORE = 1.0;
+
+CatalogWarmer::CatalogWarmer(Config config) : config_(config) {}
+
+CatalogWarmer::~CatalogWarmer() {
+    stop();
+}
+
+void CatalogWarmer::pin(const std::string& query, int pages) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, added] = entries_.try_emplace(query);
+    Entry& e = it->second;
+    if (!added && !e.pinned)
+        ranking_.erase(e.rank);
+    e.pinned = true;
+    e.pages  = std::max(e.pages, pages);
+}
+
+double CatalogWarmer::decayedLocked(const Entry& e, Clock::time_point now) const {
+    double dt = std::chrono::duration<double>(now - e.scoredAt).count();
+    return e.score * std::exp2(-dt / config_.halfLifeSec);
+}
+
+// Every count decays at the same rate, so the order of two queries only
+// changes when one is requested: log2 of the count, brought forward to
+// origin_, ranks it until then.
+double CatalogWarmer::rankLocked(const Entry& e) const {
+    double t = std::chrono::duration<double>(e.scoredAt - origin_).count();
+    return std::log2(e.score) + t / config_.halfLifeSec;
+}
+
+void CatalogWarmer::recordQuery(const std::string& query) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+
+    auto [it, added] = entries_.try_emplace(query);
+    Entry& e   = it->second;
+    e.score    = decayedLocked(e, now) + 1.0;
+    e.scoredAt = now;
+
+    // A requested query is warmed as deep as /search reads it, pinned or
+    // not; pinned ones stay out of the ranking since they are never evicted
+    e.pages = std::max(e.pages, config_.hotPages);
+    if (e.pinned) return;
+
+    if (!added)
+        ranking_.erase(e.rank);
+    e.rank = ranking_.emplace(rankLocked(e), query);
+
+    if (ranking_.size() > MAX_TRACKED_QUERIES) {
+        auto coldest = ranking_.begin();
+        if (coldest == e.rank) ++coldest;
+        entries_.erase(coldest->second);
+        ranking_.erase(coldest);
+    }
+}
+
+// Pinned queries plus the `hotQueries` most requested /search terms.
+std::vector<std::string> CatalogWarmer::warmSetLocked(Clock::time_point now) const {
+    std::vector<std::string>                    warm;
+    std::vector<std::pair<double, std::string>> hot;
+
+    for (const auto& [query, e] : entries_) {
+        if (e.pinned) {
+            warm.push_back(query);
+            continue;
+        }
+        double score = decayedLocked(e, now);
+        if (score >= MIN_HOT_SCORE)
+            hot.emplace_back(score, query);
+    }
+
+    size_t keep = std::min(hot.size(), static_cast<size_t>(std::max(0, config_.hotQueries)));
+    std::partial_sort(hot.begin(), hot.begin() + keep, hot.end(),
+                      [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = 0; i < keep; i++)
+        warm.push_back(hot[i].second);
+    return warm;
+}
+
+// Chooses the next query to refresh: among warm queries that are due, the
+// most requested one (never-refreshed queries count as due). Sets `nextDue`
+// to the earliest time a not-yet-due warm query becomes due.
+std::string CatalogWarmer::pickLocked(Clock::time_point now, Clock::time_point* nextDue) {
+    std::string best;
+    double      bestScore = -1.0;
+
+    for (const auto& query : warmSetLocked(now)) {
+        const Entry& e = entries_.at(query);
+
+        Clock::time_point due = e.refreshed ? e.refreshedAt + config_.interval : now;
+        if (due > now) {
+            *nextDue = std::min(*nextDue, due);
+            continue;
+        }
+
+        double score = decayedLocked(e, now);
+        if (score > bestScore) {
+            best      = query;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+void CatalogWarmer::start(Refresh refresh) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) return;
+    refresh_  = std::move(refresh);
+    stopping_ = false;
+    thread_   = std::thread([this]() { run(); });
+}
+
+void CatalogWarmer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void CatalogWarmer::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!stopping_) {
+        auto now     = Clock::now();
+        auto nextDue = now + config_.interval;
+
+        std::string query = pickLocked(now, &nextDue);
+        if (query.empty()) {
+            wake_.wait_until(lock, nextDue);
+            continue;
+        }
+
+        // Only spend limiter tokens that user traffic is leaving unused
+        if (steamLimiter().available() < config_.headroom + 1.0) {
+            wake_.wait_for(lock, steamLimiter().interval() * 2);
+            continue;
+        }
+
+        int pages = entries_[query].pages;
+        lock.unlock();
+
+        auto       began  = Clock::now();
+        WarmResult result = refresh_(query, pages);
+        double     ms     = std::chrono::duration<double, std::milli>(Clock::now() - began).count();
+
+        lock.lock();
+        auto it = entries_.find(query);
+        if (it != entries_.end()) {
+            Entry& e      = it->second;
+            e.refreshed   = true;
+            e.refreshedAt = Clock::now();
+            e.last        = result;
+            e.lastMs      = ms;
+            e.refreshes++;
+        }
+
+        LOG_INFO("catalogWarmer") << query << " | " << result.pagesOk << "/"
+                                  << result.pagesTotal << " pages, " << result.items << " items in "
+                                  << ms << "ms";
+    }
+}
+
+std::vector<WarmStatus> CatalogWarmer::status() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+
+    std::vector<WarmStatus> out;
+    for (const auto& query : warmSetLocked(now)) {
+        const Entry& e = entries_.at(query);
+
+        double age = e.refreshed ? std::chrono::duration<double>(now - e.refreshedAt).count() : -1.0;
+        double due = e.refreshed ? config_.interval.count() - age : 0.0;
+        out.push_back({
+            query,
+            e.pinned,
+            e.pages,
+            age,
+            due,
+            decayedLocked(e, now),
+            e.last.items,
+            e.last.pagesOk,
+            e.lastMs,
+            e.refreshes
+        });
+    }
+
+    std::sort(out.begin(), out.end(), [](const WarmStatus& a, const WarmStatus& b) {
+        return a.recent_requests > b.recent_requests;
+    });
+    return out;
+}
+
+CatalogWarmer& catalogWarmer() {
+    static CatalogWarmer warmer({
+        std::chrono::seconds(std::max(1, envInt("SKIN_WARM_INTERVAL_SEC", 240))),
+        envInt("SKIN_WARM_HOT_QUERIES", 10),
+        envInt("SKIN_WARM_HOT_PAGES",   10),
+        static_cast<double>(envInt("SKIN_WARM_HEADROOM", steamLimiter().burst() / 2)),
+        600.0
+    });
+    return warmer;
+}
@@ -0,0 +1,114 @@
+#include "circuit_breaker.h"
+#include "config.h"
+#include "log.h"
+
+#include <algorithm>
+
+CircuitBreaker::CircuitBreaker(BreakerConfig config)
+    : config_(config), openFor_(config.open) {
+    config_.failures = std::max(1, config_.failures);
+    config_.open     = std::max(config_.open, std::chrono::seconds(1));
+    config_.maxOpen  = std::max(config_.maxOpen, config_.open);
+    openFor_         = config_.open;
+}
+
+bool CircuitBreaker::allow(bool* probe) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *probe = false;
+    switch (state_) {
+    case BreakerState::Closed:
+        return true;
+    case BreakerState::Open:
+        if (Clock::now() < openUntil_) return false;
+        state_   = BreakerState::HalfOpen;
+        probing_ = true;
+        *probe   = true;
+        LOG_INFO("breaker") << "Half-open: probing Steam";
+        return true;
+    case BreakerState::HalfOpen:
+        if (probing_) return false;
+        probing_ = true;
+        *probe   = true;
+        return true;
+    }
+    return false;
+}
+
+bool CircuitBreaker::isOpen() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (state_ == BreakerState::Open && Clock::now() < openUntil_) ||
+           (state_ == BreakerState::HalfOpen && probing_);
+}
+
+void CircuitBreaker::succeeded(bool probe) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == BreakerState::Closed) {
+        consecutive_ = 0;
+        return;
+    }
+    if (!probe) return;   // sent before the breaker opened
+
+    LOG_INFO("breaker") << "Closed: Steam is answering again";
+    state_   = BreakerState::Closed;
+    probing_ = false;
+    openFor_ = config_.open;
+}
+
+void CircuitBreaker::failed(std::chrono::seconds retryAfter, bool probe) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+
+    switch (state_) {
+    case BreakerState::Closed:
+        if (++consecutive_ >= config_.failures)
+            openLocked(now, retryAfter);
+        break;
+    case BreakerState::HalfOpen:
+        if (!probe) break;   // sent before the breaker opened
+        // The probe failed; back off further before the next one
+        openFor_ = std::min(config_.maxOpen, openFor_ * 2);
+        openLocked(now, retryAfter);
+        break;
+    case BreakerState::Open:
+        // A transfer started before the breaker opened; only a longer
+        // Retry-After matters now
+        openUntil_ = std::max(openUntil_, now + retryAfter);
+        break;
+    }
+}
+
+void CircuitBreaker::openLocked(Clock::time_point now, std::chrono::seconds retryAfter) {
+    auto period  = std::max(openFor_, retryAfter);
+    state_       = BreakerState::Open;
+    probing_     = false;
+    consecutive_ = 0;
+    openUntil_   = now + period;
+    opens_++;
+    LOG_WARN("breaker") << "Open for " << period.count() << "s: Steam is refusing requests";
+}
+
+BreakerStats CircuitBreaker::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    double retryIn = 0.0;
+    if (state_ == BreakerState::Open)
+        retryIn = std::max(0.0, std::chrono::duration<double>(openUntil_ - Clock::now()).count());
+    return {state_, opens_.load(), rejected_.load(), retryIn};
+}
+
+const char* breakerStateName(BreakerState state) {
+    switch (state) {
+    case BreakerState::Closed:   return "closed";
+    case BreakerState::Open:     return "open";
+    case BreakerState::HalfOpen: return "half_open";
+    }
+    return "closed";
+}
+
+CircuitBreaker& upstreamBreaker() {
+    static CircuitBreaker breaker({
+        envInt("SKIN_BREAKER_FAILURES", 5),
+        std::chrono::seconds(envInt("SKIN_BREAKER_OPEN_SEC", 10)),
+        std::chrono::seconds(envInt("SKIN_BREAKER_MAX_OPEN_SEC", 300)),
+    });
+    return breaker;
+}
@@ -0,0 +1,71 @@
+#include "executor.h"
+#include "config.h"
+
+#include <algorithm>
+#include <chrono>
+
+Executor::Executor(int threads, const std::string& name)
+    : busyNs_(metrics().secondsCounter(
+          "cs_skin_worker_busy_seconds_total", "Time worker threads spent running jobs",
+          "pool=\"" + name + "\"")) {
+    int n = std::max(1, threads);
+    metrics().gauge("cs_skin_worker_threads", "Worker threads per pool", "pool=\"" + name + "\"",
+                    [n]() { return static_cast<double>(n); });
+    workers_.reserve(n);
+    for (int i = 0; i < n; i++)
+        workers_.emplace_back([this]() { run(); });
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto& t : workers_)
+        t.join();
+}
+
+void Executor::post(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(job));
+    }
+    ready_.notify_one();
+}
+
+void Executor::run() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (stopping_ && queue_.empty()) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        auto began = std::chrono::steady_clock::now();
+        job();
+        busyNs_.inc(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - began).count()));
+    }
+}
+
+Executor& computeExecutor() {
+    static Executor executor(
+        envInt("SKIN_COMPUTE_THREADS", static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))),
+        "compute");
+    return executor;
+}
+
+void resumeRequest(std::thread::id origin, std::function<void()> work) {
+    if (std::this_thread::get_id() == origin)
+        work();
+    else
+        computeExecutor().post(std::move(work));
+}
+
+Executor& upstreamExecutor() {
+    static Executor executor(envInt("SKIN_UPSTREAM_THREADS", 16), "upstream");
+    return executor;
+}
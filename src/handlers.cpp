@@ -0,0 +1,763 @@
+#include "handlers.h"
+#include "budget_table.h"
+#include "catalog_warmer.h"
+#include "circuit_breaker.h"
+#include "config.h"
+#include "executor.h"
+#include "subset_sum.h"
+#include "log.h"
+#include "market_cache.h"
+#include "market_fetch.h"
+#include "metrics.h"
+#include "price_fetch.h"
+#include "price_history.h"
+#include "rate_limiter.h"
+#include "response_cache.h"
+#include "responses.h"
+#include "search_index.h"
+#include "slot_fetch.h"
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+// ─── Metrics ───────────────────────────────────────────────
+
+namespace {
+
+struct RouteMetrics {
+    const char*  path;
+    Histogram&   latency;
+    CodeCounters responses;
+};
+
+RouteMetrics makeRouteMetrics(const char* path) {
+    std::string labels = std::string("route=\"") + path + "\"";
+    return {
+        path,
+        metrics().histogram("cs_skin_http_request_duration_seconds", "Request latency per route", labels),
+        CodeCounters("cs_skin_http_requests_total", "Requests per route and status code", labels),
+    };
+}
+
+RouteMetrics& routeMetrics(const std::string& url) {
+    // One fixed series per route, so arbitrary paths cannot grow the registry
+    static RouteMetrics routes[] = {
+        makeRouteMetrics("/"),
+        makeRouteMetrics("/health"),
+        makeRouteMetrics("/metrics"),
+        makeRouteMetrics("/cache/stats"),
+        makeRouteMetrics("/catalog/status"),
+        makeRouteMetrics("/search"),
+        makeRouteMetrics("/search/stream"),
+        makeRouteMetrics("/price"),
+        makeRouteMetrics("/price/batch"),
+        makeRouteMetrics("/price/batch/stream"),
+        makeRouteMetrics("/history"),
+        makeRouteMetrics("/budget/optimize"),
+        makeRouteMetrics("/budget/sweep"),
+        makeRouteMetrics("/loadout/build"),
+        makeRouteMetrics("other"),
+    };
+    constexpr size_t known = sizeof(routes) / sizeof(routes[0]) - 1;
+
+    for (size_t i = 0; i < known; i++)
+        if (url == routes[i].path) return routes[i];
+    return routes[known];
+}
+
+// Cache sizes and upstream health, read at scrape time.
+void registerStateGauges() {
+    metrics().gauge("cs_skin_market_cache_entries", "Search pages held by the market cache", "",
+                    []() { return static_cast<double>(marketCache().stats().entries); });
+    metrics().gauge("cs_skin_search_index_items", "Skins in the search index", "",
+                    []() { return static_cast<double>(searchIndex().stats().items); });
+    metrics().gauge("cs_skin_history_samples", "Price history samples held in memory", "",
+                    []() { return static_cast<double>(priceHistory().stats().samples); });
+    metrics().gauge("cs_skin_history_bytes", "Memory held by the price history, buffers counted at capacity", "",
+                    []() { return static_cast<double>(priceHistory().stats().bytes); });
+    metrics().gauge("cs_skin_response_cache_bytes", "Bytes held by the response cache", "",
+                    []() { return static_cast<double>(responseCache().stats().bytes); });
+    metrics().gauge("cs_skin_upstream_breaker_state", "Steam circuit breaker: 0 closed, 1 open, 2 half-open", "",
+                    []() { return static_cast<double>(upstreamBreaker().stats().state); });
+    metrics().gauge("cs_skin_upstream_interval_seconds", "Current spacing between Steam requests", "",
+                    []() { return steamLimiter().interval().count() / 1000.0; });
+}
+
+} // namespace
+
+void RequestMetrics::before_handle(crow::request&, crow::response&, context& ctx) {
+    ctx.began = std::chrono::steady_clock::now();
+}
+
+void RequestMetrics::after_handle(crow::request& req, crow::response& res, context& ctx) {
+    static Counter& busyNs = metrics().secondsCounter(
+        "cs_skin_worker_busy_seconds_total", "Time worker threads spent running jobs", "pool=\"http\"");
+
+    auto elapsed = std::chrono::steady_clock::now() - ctx.began;
+    auto busy    = ctx.deferred ? ctx.handled : elapsed;
+    busyNs.inc(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count()));
+
+    RouteMetrics& route = routeMetrics(req.url);
+    route.latency.observe(std::chrono::duration<double>(elapsed).count());
+    route.responses.inc(res.code);
+}
+
+// ─── Asynchronous Requests ─────────────────────────────────
+
+// Finishes a deferred request: builds its response through resumeRequest()
+// and hands it to `respond`, turning an exception into an error body.
+static void resume(std::thread::id origin, Respond respond, std::function<crow::response()> build) {
+    resumeRequest(origin, [respond = std::move(respond), build = std::move(build)]() {
+        crow::response res;
+        try {
+            res = build();
+        } catch (const std::exception& e) {
+            crow::json::wvalue err;
+            err["error"] = e.what();
+            res = crow::response(err);
+        }
+        respond(std::move(res));
+    });
+}
+
+static crow::response errorResponse(const std::string& message) {
+    crow::json::wvalue e;
+    e["error"] = message;
+    return crow::response(e);
+}
+
+// ─── Handlers ──────────────────────────────────────────────
+
+crow::response handleMetrics() {
+    static std::once_flag gauges;
+    std::call_once(gauges, registerStateGauges);
+
+    crow::response res(metrics().render());
+    res.set_header("Content-Type", "text/plain; version=0.0.4; charset=utf-8");
+    return res;
+}
+
+crow::response handleCacheStats() {
+    CacheStats st = marketCache().stats();
+    long long lookups = st.hits + st.misses + st.stale;
+
+    crow::json::wvalue r;
+    r["hits"]        = st.hits;
+    r["misses"]      = st.misses;
+    r["stale"]       = st.stale;
+    r["refreshes"]   = st.refreshes;
+    r["evictions"]   = st.evictions;
+    r["coalesced"]   = coalescedPageFetches();
+    r["entries"]     = static_cast<int>(st.entries);
+    r["ttl_seconds"] = st.ttl_seconds;
+    r["hit_ratio"]   = lookups > 0 ? static_cast<double>(st.hits + st.stale) / lookups : 0.0;
+
+    SearchIndexStats idx = searchIndex().stats();
+    r["index_items"] = static_cast<int>(idx.items);
+    r["index_terms"] = static_cast<int>(idx.terms);
+
+    ResponseCacheStats rc = responseCache().stats();
+    r["response_hits"]    = rc.hits;
+    r["response_misses"]  = rc.misses;
+    r["not_modified"]     = rc.notModified;
+    r["response_entries"] = static_cast<int>(rc.entries);
+    r["response_bytes"]   = static_cast<long long>(rc.bytes);
+
+    PriceCacheStats pc = priceCache().stats();
+    r["price_hits"]    = pc.hits;
+    r["price_misses"]  = pc.misses;
+    r["price_entries"] = static_cast<int>(pc.entries);
+
+    HistoryStats hs = priceHistory().stats();
+    r["history_items"]   = static_cast<long long>(hs.items);
+    r["history_samples"] = static_cast<long long>(hs.samples);
+    r["history_bytes"]   = static_cast<long long>(hs.bytes);
+
+    BudgetTableStats bt = budgetTables().stats();
+    r["budget_table_hits"]    = bt.hits;
+    r["budget_table_misses"]  = bt.misses;
+    r["budget_table_entries"] = static_cast<int>(bt.entries);
+    r["budget_table_bytes"]   = static_cast<long long>(bt.bytes);
+
+    BreakerStats bs = upstreamBreaker().stats();
+    r["breaker_state"]     = breakerStateName(bs.state);
+    r["breaker_opens"]     = bs.opens;
+    r["breaker_retry_in"]  = bs.retryInSeconds;
+    r["upstream_rejected"] = bs.rejected;
+    r["steam_interval_ms"] = static_cast<long long>(steamLimiter().interval().count());
+    return crow::response(r);
+}
+
+crow::response handleCatalogStatus() {
+    std::vector<crow::json::wvalue> queries;
+    for (const auto& st : catalogWarmer().status()) {
+        crow::json::wvalue q;
+        q["query"]           = st.query;
+        q["pinned"]          = st.pinned;
+        q["pages"]           = st.pages;
+        q["age_seconds"]     = st.age_seconds;
+        q["due_in_seconds"]  = st.due_in_seconds;
+        q["recent_requests"] = st.recent_requests;
+        q["items"]           = st.items;
+        q["pages_ok"]        = st.pages_ok;
+        q["last_refresh_ms"] = st.last_refresh_ms;
+        q["refreshes"]       = st.refreshes;
+        queries.push_back(std::move(q));
+    }
+
+    crow::json::wvalue r;
+    r["interval_seconds"] = static_cast<int>(catalogWarmer().config().interval.count());
+    r["queries"]          = std::move(queries);
+    return crow::response(r);
+}
+
+static bool isSearchSort(const std::string& sort) {
+    return sort.empty() || sort == "price_desc" || sort == "price_asc" || sort == "listings" ||
+           sort == "name";
+}
+
+// Parses a whole decimal integer; trailing characters are an error rather
+// than silently ignored.
+static bool parseInteger(const char* text, long long* out) {
+    if (!text || !*text) return false;
+    char* end = nullptr;
+    errno     = 0;
+    *out      = std::strtoll(text, &end, 10);
+    return errno == 0 && *end == '\0';
+}
+
+// Parses a whole finite decimal number; "nan", "inf" and trailing
+// characters are errors.
+static bool parseNumber(const char* text, double* out) {
+    if (!text || !*text) return false;
+    char* end = nullptr;
+    *out      = std::strtod(text, &end);
+    return *end == '\0' && std::isfinite(*out);
+}
+
+// Orders /search results; the index already returns price_desc.
+static void sortSkins(std::vector<Skin>& skins, const std::string& sort) {
+    if (sort == "price_asc")
+        std::reverse(skins.begin(), skins.end());
+    else if (sort == "listings")
+        std::stable_sort(skins.begin(), skins.end(), [](const Skin& a, const Skin& b) {
+            return a.listings > b.listings;
+        });
+    else if (sort == "name")
+        std::stable_sort(skins.begin(), skins.end(), [](const Skin& a, const Skin& b) {
+            return interned(a.name) < interned(b.name);
+        });
+}
+
+void handleSearch(const crow::request& req, Respond respond) {
+    // A page is the unit clients render; full result sets stay available
+    // by leaving `limit` out
+    constexpr long long MAX_LIMIT = 1000;
+
+    std::string query = req.url_params.get("q") ? req.url_params.get("q") : "";
+    if (query.empty())
+        return respond(errorResponse("Missing query parameter ?q="));
+
+    auto text = [&](const char* key) {
+        const char* v = req.url_params.get(key);
+        return v ? std::string(v) : std::string();
+    };
+
+    double min_d = 0.0;
+    double max_d = SEARCH_MAX_PRICE;
+    if ((req.url_params.get("min") && !parseNumber(req.url_params.get("min"), &min_d)) ||
+        (req.url_params.get("max") && !parseNumber(req.url_params.get("max"), &max_d)))
+        return respond(errorResponse("min and max must be prices in dollars"));
+
+    SearchFilter filter;
+    filter.min_cents = static_cast<int>(std::lround(std::clamp(min_d, 0.0, SEARCH_MAX_PRICE) * 100));
+    filter.max_cents = static_cast<int>(std::lround(std::clamp(max_d, 0.0, SEARCH_MAX_PRICE) * 100));
+    filter.weapon    = text("weapon");
+
+    std::string error;
+    filter.wears = parseWearList(text("wear"), &error);
+    if (!error.empty())
+        return respond(errorResponse(error));
+
+    std::string stattrak = text("stattrak");
+    if (stattrak == "1" || stattrak == "true")
+        filter.stattrak = 1;
+    else if (stattrak == "0" || stattrak == "false")
+        filter.stattrak = 0;
+    else if (!stattrak.empty())
+        return respond(errorResponse("stattrak must be 0, 1, true or false"));
+
+    std::string sort = text("sort");
+    if (!isSearchSort(sort))
+        return respond(errorResponse("sort must be price_desc, price_asc, listings or name"));
+
+    // The cursor is the offset of the next result; clients pass back
+    // next_cursor as-is
+    long long limit  = 0;
+    long long offset = 0;
+    if (req.url_params.get("limit") &&
+        (!parseInteger(req.url_params.get("limit"), &limit) || limit < 1 || limit > MAX_LIMIT))
+        return respond(errorResponse("limit must be between 1 and " + std::to_string(MAX_LIMIT)));
+    if (req.url_params.get("cursor") && (!parseInteger(req.url_params.get("cursor"), &offset) || offset < 0))
+        return respond(errorResponse("Invalid cursor"));
+
+    catalogWarmer().recordQuery(query);
+
+    // Make sure the query's own pages are cached (Steam is only asked for
+    // missing ones; stale ones refresh in the background), then answer
+    // from the index, which also covers skins seen under other queries.
+    // Cached pages at least half the index's max age old are indexed again
+    // first, so none of their skins has expired and /search returns what
+    // /search/stream would.
+    constexpr int PAGES = 10;
+
+    auto origin = std::this_thread::get_id();
+    auto served = std::make_shared<std::vector<SkinPage>>(PAGES * 2);
+    auto keep   = [served](size_t i, const SkinPage& page) { (*served)[i] = page; };
+    visitQueryPagesAsync(query, PAGES, keep, [&req, respond, origin, query, filter, sort, limit, offset, served](const PageFreshness& pages) {
+        resume(origin, respond, [&req, query, filter, sort, limit, offset, pages, served]() {
+            if (pages.ageSeconds * 2 >= static_cast<double>(searchIndex().maxAge().count()))
+                searchIndex().add(*served, query);
+
+            auto began = std::chrono::steady_clock::now();
+            std::vector<Skin> skins = searchIndex().search(query, filter);
+            sortSkins(skins, sort);
+            double indexMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - began).count();
+
+            LOG_DEBUG("search") << query << " | " << pages.fromSteam << " pages from Steam, "
+                                << skins.size() << " skins from index in " << indexMs << "ms";
+
+            size_t first = std::min(static_cast<size_t>(offset), skins.size());
+            size_t last  = limit ? std::min(skins.size(), first + static_cast<size_t>(limit)) : skins.size();
+
+            std::string key = "search\x1f" + query + '\x1f' + std::to_string(filter.min_cents) + '\x1f' +
+                              std::to_string(filter.max_cents) + '\x1f' + std::to_string(filter.wears) + '\x1f' +
+                              std::to_string(filter.stattrak) + '\x1f' + filter.weapon + '\x1f' + sort + '\x1f' +
+                              std::to_string(first) + '\x1f' + std::to_string(last) + '\x1f' +
+                              skinsFingerprint(skins);
+            return sendPages(req, key, pages, [&]() {
+                std::vector<crow::json::wvalue> results;
+                results.reserve(last - first);
+                for (size_t i = first; i < last; i++)
+                    results.push_back(skinToJson(skins[i]));
+
+                crow::json::wvalue r;
+                r["total_count"] = static_cast<int>(skins.size());
+                r["results"]     = std::move(results);
+                if (last < skins.size())
+                    r["next_cursor"] = std::to_string(last);
+                return r;
+            });
+        });
+    });
+}
+
+void handlePrice(const crow::request& req, Respond respond) {
+    std::string name = req.url_params.get("name") ? req.url_params.get("name") : "";
+    if (name.empty())
+        return respond(errorResponse("Missing name parameter ?name="));
+
+    // A single quote serializes in microseconds, so it is answered from
+    // whichever thread delivered it
+    auto r = std::make_shared<crow::json::wvalue>();
+    fetchPrices({name}, [r](const PriceResult& result) {
+        *r = priceToJson(result);
+    }, [r, respond](PriceBatchStats) {
+        respond(crow::response(*r));
+    });
+}
+
+std::vector<std::string> priceBatchNames(const std::string& body, std::string* error) {
+    try {
+        auto parsed = json::parse(body);
+        auto names  = parsed.find("names");
+        if (names == parsed.end() || !names->is_array() || names->empty()) {
+            *error = "Missing names array";
+            return {};
+        }
+
+        static const size_t maxNames = static_cast<size_t>(std::max(1, envInt("SKIN_PRICE_BATCH_MAX", 5000)));
+        if (names->size() > maxNames) {
+            *error = "A batch cannot exceed " + std::to_string(maxNames) + " names";
+            return {};
+        }
+
+        std::vector<std::string> out;
+        out.reserve(names->size());
+        for (const auto& n : *names) {
+            if (!n.is_string()) {
+                *error = "names must be strings";
+                return {};
+            }
+            out.push_back(n.get<std::string>());
+        }
+        return out;
+    } catch (const std::exception& e) {
+        *error = e.what();
+        return {};
+    }
+}
+
+void handlePriceBatch(const crow::request& req, Respond respond) {
+    auto started = std::chrono::steady_clock::now();
+
+    std::string              error;
+    std::vector<std::string> names = priceBatchNames(req.body, &error);
+    if (names.empty())
+        return respond(errorResponse(error));
+
+    auto results = std::make_shared<std::vector<crow::json::wvalue>>();
+    results->reserve(names.size());
+    auto origin    = std::this_thread::get_id();
+    int  requested = static_cast<int>(names.size());
+    fetchPrices(names, [results](const PriceResult& result) {
+        results->push_back(priceToJson(result));
+    }, [&req, respond, origin, results, requested, started](PriceBatchStats stats) {
+        resume(origin, respond, [&req, results, requested, started, stats]() {
+            crow::json::wvalue r;
+            r["results"]    = std::move(*results);
+            r["requested"]  = requested;
+            r["unique"]     = stats.unique;
+            r["cached"]     = stats.cached;
+            r["fetched"]    = stats.fetched;
+            r["shared"]     = stats.shared;
+            r["stale"]      = stats.stale;
+            r["failed"]     = stats.failed;
+            r["elapsed_ms"] = secondsSince(started) * 1000.0;
+            return sendJson(req, r);
+        });
+    }, FetchPriority::Background);
+}
+
+crow::response handleHistory(const crow::request& req) {
+    std::string name = req.url_params.get("name") ? req.url_params.get("name") : "";
+    if (name.empty()) {
+        crow::json::wvalue e;
+        e["error"] = "Missing name parameter ?name=";
+        return crow::response(e);
+    }
+
+    // Charts need at most a few hundred points; wider requests get a coarser step
+    constexpr long long MAX_POINTS = 1000;
+
+    // Far past any sample, and small enough that spans and step
+    // arithmetic cannot overflow
+    constexpr long long MAX_TIME = 1LL << 40;
+
+    auto param = [&](const char* key, long long fallback, long long* out) {
+        const char* v = req.url_params.get(key);
+        *out = fallback;
+        return !v || parseInteger(v, out);
+    };
+    long long now  = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    long long to   = 0;
+    long long from = 0;
+    long long step = 0;
+    if (!param("to", now, &to) || !param("from", std::max(to, 0LL) - 86400, &from) || !param("step", 0, &step)) {
+        crow::json::wvalue e;
+        e["error"] = "from, to and step must be whole numbers";
+        return crow::response(e);
+    }
+    to   = std::clamp(to,   0LL, MAX_TIME);
+    from = std::clamp(from, 0LL, MAX_TIME);
+    if (to <= from) {
+        crow::json::wvalue e;
+        e["error"] = "to must be after from";
+        return crow::response(e);
+    }
+    long long span = to - from;
+    if (!req.url_params.get("step"))
+        step = (span + 199) / 200;
+    step = std::max({step, (span + MAX_POINTS - 1) / MAX_POINTS, 1LL});
+
+    std::vector<HistoryPoint> series = priceHistory().query(findInterned(name), from, to, step);
+
+    std::vector<crow::json::wvalue> points;
+    points.reserve(series.size());
+    for (const auto& p : series) {
+        crow::json::wvalue j;
+        j["t"]        = static_cast<long long>(p.t);
+        j["open"]     = p.open;
+        j["low"]      = p.low;
+        j["high"]     = p.high;
+        j["close"]    = p.close;
+        j["listings"] = p.listings;
+        j["samples"]  = p.samples;
+        points.push_back(std::move(j));
+    }
+
+    crow::json::wvalue r;
+    r["name"]   = name;
+    r["from"]   = from;
+    r["to"]     = to;
+    r["step"]   = step;
+    r["points"] = std::move(points);
+    return sendJson(req, r);
+}
+
+// One budget's selection from a precomputed table, in the shape shared by
+// /budget/optimize and the /budget/sweep points.
+static crow::json::wvalue budgetSelection(
+    const std::vector<Skin>& skins,
+    const SubsetSumTable&    table,
+    int                      budget_cents,
+    bool                     withSkins
+) {
+    std::vector<int> chosen      = table.choose(budget_cents);
+    double           budget      = budget_cents / 100.0;
+    double           total_spent = table.best(budget_cents) / 100.0;
+
+    crow::json::wvalue r;
+    r["budget"]         = budget;
+    r["total_spent"]    = total_spent;
+    r["remaining"]      = budget - total_spent;
+    r["skins_selected"] = static_cast<int>(chosen.size());
+    if (withSkins) {
+        std::vector<crow::json::wvalue> selected;
+        selected.reserve(chosen.size());
+        for (int i : chosen)
+            selected.push_back(skinToOptionJson(skins[i]));
+        r["skins"] = std::move(selected);
+    }
+    return r;
+}
+
+static int skinsWithin(const std::vector<Skin>& skins, int budget_cents) {
+    return static_cast<int>(std::count_if(skins.begin(), skins.end(), [&](const Skin& s) {
+        return s.price_cents <= budget_cents;
+    }));
+}
+
+void handleBudgetOptimize(const crow::request& req, Respond respond) {
+    double      budget = 0.0;
+    std::string query;
+    try {
+        auto body = json::parse(req.body);
+        budget = body.value("budget", 0.0);
+        query  = body.value("query", "");
+    } catch (const std::exception& e) {
+        return respond(errorResponse(e.what()));
+    }
+
+    if (budget <= 0 || query.empty())
+        return respond(errorResponse("Missing or invalid budget/query"));
+
+    if (budget > 10000.0)
+        return respond(errorResponse("Budget cannot exceed $10,000"));
+
+    int budget_cents = static_cast<int>(std::lround(budget * 100));
+    catalogWarmer().recordQuery(query);
+
+    // Every budget for a query shares one item set, and so one budget table
+    auto origin = std::this_thread::get_id();
+    fetchQuery(query, 10, 1, MAX_BUDGET_CENTS, [&req, respond, origin, query, budget_cents](std::vector<Skin> fetched, const PageFreshness& pages) {
+        auto skins = std::make_shared<std::vector<Skin>>(std::move(fetched));
+        resume(origin, respond, [&req, skins, pages, query, budget_cents]() {
+            int found = skinsWithin(*skins, budget_cents);
+            if (found == 0)
+                return errorResponse("No skins found within budget.");
+
+            // A hit skips both the table lookup and serialization
+            std::string fingerprint = skinsFingerprint(*skins);
+            std::string key = "budget\x1f" + query + '\x1f' + std::to_string(budget_cents) + '\x1f' + fingerprint;
+
+            return sendPages(req, key, pages, [&]() {
+                bool              cached = false;
+                SubsetSumTablePtr table  = budgetTables().get(fingerprint, *skins, &cached);
+
+                // A cached table costs this request a lookup, not a build
+                crow::json::wvalue r   = budgetSelection(*skins, *table, budget_cents, true);
+                r["skins_found"]       = found;
+                r["algorithm"]         = table->total() <= budget_cents ? "take_all" : "budget_table";
+                r["table_cached"]      = cached;
+                r["dp_cells"]          = cached ? 0LL : table->cells();
+                r["peak_memory_bytes"] = static_cast<long long>(table->bytes());
+                return r;
+            });
+        });
+    });
+}
+
+void handleBudgetSweep(const crow::request& req, Respond respond) {
+    // Enough resolution for a slider; finer sweeps should narrow `max`
+    constexpr long long MAX_POINTS = 1000;
+
+    std::string query = req.url_params.get("query") ? req.url_params.get("query") : "";
+    double      max       = 0.0;
+    double      step      = 1.0;
+    bool        withSkins = req.url_params.get("skins") && std::string(req.url_params.get("skins")) != "0";
+
+    if (query.empty() || !parseNumber(req.url_params.get("max"), &max) || max <= 0)
+        return respond(errorResponse("Missing or invalid query/max"));
+
+    if (max > 10000.0)
+        return respond(errorResponse("Budget cannot exceed $10,000"));
+
+    // A step past `max` is a single-point sweep at `max`
+    if (req.url_params.get("step") && !parseNumber(req.url_params.get("step"), &step))
+        return respond(errorResponse("Invalid step"));
+    step = std::min(step, max);
+
+    int max_cents  = static_cast<int>(std::lround(max * 100));
+    int step_cents = static_cast<int>(std::lround(step * 100));
+    if (step_cents <= 0)
+        return respond(errorResponse("step must be at least 0.01"));
+    if ((static_cast<long long>(max_cents) + step_cents - 1) / step_cents > MAX_POINTS)
+        return respond(errorResponse("A sweep cannot exceed " + std::to_string(MAX_POINTS) + " budgets"));
+
+    catalogWarmer().recordQuery(query);
+
+    auto origin = std::this_thread::get_id();
+    fetchQuery(query, 10, 1, MAX_BUDGET_CENTS, [&req, respond, origin, query, max_cents, step_cents, withSkins](std::vector<Skin> fetched, const PageFreshness& pages) {
+        auto skins = std::make_shared<std::vector<Skin>>(std::move(fetched));
+        resume(origin, respond, [&req, skins, pages, query, max_cents, step_cents, withSkins]() {
+            int found = skinsWithin(*skins, max_cents);
+            if (found == 0)
+                return errorResponse("No skins found within budget.");
+
+            std::string fingerprint = skinsFingerprint(*skins);
+            std::string key = "sweep\x1f" + query + '\x1f' + std::to_string(max_cents) + '\x1f' +
+                              std::to_string(step_cents) + '\x1f' + (withSkins ? "1" : "0") + '\x1f' + fingerprint;
+
+            return sendPages(req, key, pages, [&]() {
+                SubsetSumTablePtr table = budgetTables().get(fingerprint, *skins);
+
+                // step, 2·step, ... and `max` itself when it is not a multiple
+                std::vector<crow::json::wvalue> points;
+                for (int cents = step_cents;; cents += step_cents) {
+                    cents = std::min(cents, max_cents);
+                    points.push_back(budgetSelection(*skins, *table, cents, withSkins));
+                    if (cents == max_cents) break;
+                }
+
+                crow::json::wvalue r;
+                r["query"]       = query;
+                r["max"]         = max_cents / 100.0;
+                r["step"]        = step_cents / 100.0;
+                r["skins_found"] = found;
+                r["points"]      = std::move(points);
+                return r;
+            });
+        });
+    });
+}
+
+void handleLoadoutBuild(const crow::request& req, Respond respond) {
+    std::string side, mode;
+    double weapons_budget = 0.0, knife_budget = 0.0, gloves_budget = 0.0, total_budget = 0.0;
+    int    top_k          = 5;
+    bool   include_knife  = true, include_gloves = true;
+    try {
+        auto body      = json::parse(req.body);
+        side           = body.value("side",           "T");
+        mode           = body.value("mode",           "split");
+        weapons_budget = body.value("weapons_budget", 0.0);
+        knife_budget   = body.value("knife_budget",   0.0);
+        gloves_budget  = body.value("gloves_budget",  0.0);
+        total_budget   = body.value("total_budget",   0.0);
+        top_k          = body.value("top_k",          5);
+        include_knife  = body.value("include_knife",  true);
+        include_gloves = body.value("include_gloves", true);
+    } catch (const std::exception& e) {
+        return respond(errorResponse(e.what()));
+    }
+
+    if (side != "T" && side != "CT")
+        return respond(errorResponse("side must be 'T' or 'CT'"));
+
+    auto origin = std::this_thread::get_id();
+
+    if (mode == "total") {
+        if (total_budget <= 0 || total_budget > 10000.0)
+            return respond(errorResponse("total_budget must be between 0 and $10,000"));
+        if (top_k < 1 || top_k > 20)
+            return respond(errorResponse("top_k must be between 1 and 20"));
+
+        std::vector<std::string> slotNames;
+        std::vector<SlotRequest> slots = jointSlots(side, static_cast<int>(std::lround(total_budget * 100)),
+                                                    include_knife, include_gloves,
+                                                    slotNames);
+        fetchSlots(slots, [&req, respond, origin, side, total_budget, top_k, slotNames](std::vector<SlotFetch> fetched) {
+            auto fetches = std::make_shared<std::vector<SlotFetch>>(std::move(fetched));
+            resume(origin, respond, [&req, fetches, side, total_budget, top_k, slotNames]() {
+                crow::json::wvalue r = buildJointLoadouts(side, total_budget, top_k, slotNames, *fetches);
+                markStale(r, slotFreshness(*fetches));
+                return sendJson(req, r);
+            });
+        });
+        return;
+    }
+
+    if (weapons_budget <= 0)
+        return respond(errorResponse("weapons_budget must be greater than 0"));
+
+    int primary_cents   = static_cast<int>(std::lround(weapons_budget / 2.0 * 100));
+    int secondary_cents = static_cast<int>(std::lround(weapons_budget / 2.0 * 100));
+    int knife_cents     = static_cast<int>(std::lround(knife_budget  * 100));
+    int gloves_cents    = static_cast<int>(std::lround(gloves_budget * 100));
+
+    LOG_DEBUG("loadout/build") << "side=" << side
+                               << " weapons=" << weapons_budget
+                               << " knife="   << knife_budget
+                               << " gloves="  << gloves_budget;
+
+    // Weapon lists per side
+    std::vector<std::string> primary_queries;
+    std::vector<std::string> secondary_queries;
+    sideQueries(side, primary_queries, secondary_queries);
+
+    // Every slot's weapon queries go out together
+    std::vector<std::string> slotNames = {"primary", "secondary"};
+    std::vector<SlotRequest> slots     = {
+        {primary_queries,   primary_cents},
+        {secondary_queries, secondary_cents},
+    };
+    if (knife_cents > 0) {
+        slotNames.push_back("knife");
+        slots.push_back({{"Knife"}, knife_cents});
+    }
+    if (gloves_cents > 0) {
+        slotNames.push_back("gloves");
+        slots.push_back({{"Gloves"}, gloves_cents});
+    }
+
+    fetchSlots(slots, [&req, respond, origin, side, weapons_budget, knife_budget, gloves_budget, slotNames](std::vector<SlotFetch> fetched) {
+        auto fetches = std::make_shared<std::vector<SlotFetch>>(std::move(fetched));
+        resume(origin, respond, [&req, fetches, side, weapons_budget, knife_budget, gloves_budget, slotNames]() {
+            crow::json::wvalue slots;
+            crow::json::wvalue timing;
+            for (size_t i = 0; i < fetches->size(); i++) {
+                double ms   = 0.0;
+                auto   opts = interleaveOptions(finishSlotFetch((*fetches)[i], &ms), 5);
+                timing[slotNames[i]] = ms;
+                if (!opts.empty())
+                    slots[slotNames[i]] = std::move(opts);
+            }
+            timing["total"] = std::chrono::duration<double, std::milli>(
+                SlotFetch::Clock::now() - fetches->front().started).count();
+
+            crow::json::wvalue r;
+            r["side"]           = side;
+            r["weapons_budget"] = weapons_budget;
+            r["knife_budget"]   = knife_budget;
+            r["gloves_budget"]  = gloves_budget;
+            r["slots"]          = std::move(slots);
+            r["timing_ms"]      = std::move(timing);
+            markStale(r, slotFreshness(*fetches));
+            return sendJson(req, r);
+        });
+    });
+}
@@ -0,0 +1,495 @@
+#include "http_client.h"
+#include "circuit_breaker.h"
+#include "config.h"
+#include "log.h"
+#include "metrics.h"
+#include "rate_limiter.h"
+
+#include <algorithm>
+#include <deque>
+#include <thread>
+
+static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* output) {
+    output->append(static_cast<char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
+std::string urlEncode(const std::string& str) {
+    static constexpr char HEX[] = "0123456789ABCDEF";
+
+    std::string encoded;
+    encoded.reserve(str.size() * 3);
+    for (unsigned char c : str) {
+        bool unreserved = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+                          (c >= '0' && c <= '9') ||
+                          c == '-' || c == '.' || c == '_' || c == '~';
+        if (unreserved) {
+            encoded.push_back(static_cast<char>(c));
+        } else {
+            encoded.push_back('%');
+            encoded.push_back(HEX[c >> 4]);
+            encoded.push_back(HEX[c & 0x0F]);
+        }
+    }
+    return encoded;
+}
+
+// ─── Handle Pool ───────────────────────────────────────────
+
+CurlPool::CurlPool() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    share_ = curl_share_init();
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC,   lockShared);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlockShared);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA,   this);
+    curl_share_setopt(share_, CURLSHOPT_SHARE,      CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE,      CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(share_, CURLSHOPT_SHARE,      CURL_LOCK_DATA_CONNECT);
+
+    // Steam requires browser-like headers to serve JSON
+    headers_ = curl_slist_append(headers_, "Accept-Language: en-US,en;q=0.9");
+    headers_ = curl_slist_append(headers_, "Accept: application/json, text/javascript, */*; q=0.01");
+}
+
+CurlPool::~CurlPool() {
+    for (CURL* h : idle_)
+        curl_easy_cleanup(h);
+    curl_share_cleanup(share_);
+    curl_slist_free_all(headers_);
+}
+
+void CurlPool::lockShared(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+    static_cast<CurlPool*>(userptr)->shareLocks_[data].lock();
+}
+
+void CurlPool::unlockShared(CURL*, curl_lock_data data, void* userptr) {
+    static_cast<CurlPool*>(userptr)->shareLocks_[data].unlock();
+}
+
+CURL* CurlPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty()) {
+            CURL* h = idle_.back();
+            idle_.pop_back();
+            return h;
+        }
+    }
+
+    CURL* curl = curl_easy_init();
+    if (!curl) return nullptr;
+
+    curl_easy_setopt(curl, CURLOPT_SHARE,          share_);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,  WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE,  1L);
+
+    // SSL verification disabled: MSYS2/MinGW lacks a system CA bundle, causing
+    // certificate validation failures against Steam's CDN. In a production
+    // deployment, set CURLOPT_CAINFO to a valid CA bundle path instead.
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+
+    curl_easy_setopt(curl, CURLOPT_USERAGENT,      "Mozilla/5.0 (Windows NT 10.0; Win64; x64)");
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT,        15L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER,     headers_);
+
+    return curl;
+}
+
+void CurlPool::release(CURL* handle) {
+    // Drop the caller's buffer so a stale pointer can never be written to
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, nullptr);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.push_back(handle);
+}
+
+CurlPool& curlPool() {
+    static CurlPool pool;
+    return pool;
+}
+
+// ─── Transfer Metrics ──────────────────────────────────────
+
+struct UpstreamMetrics {
+    Histogram&   latency;
+    CodeCounters responses;
+    Counter&     bytes;
+};
+
+static UpstreamMetrics makeUpstreamMetrics(const std::string& endpoint) {
+    std::string labels = "endpoint=\"" + endpoint + "\"";
+    return {
+        metrics().histogram("cs_skin_upstream_request_duration_seconds",
+                            "Steam request latency as measured by curl", labels),
+        CodeCounters("cs_skin_upstream_responses_total",
+                     "Steam responses by HTTP status; code 0 is a transport failure", labels),
+        metrics().counter("cs_skin_upstream_bytes_total", "Response bytes downloaded from Steam", labels),
+    };
+}
+
+// Records one finished transfer under its Steam endpoint.
+static void recordTransfer(CURL* h, const std::string& url, CURLcode result) {
+    static UpstreamMetrics search = makeUpstreamMetrics("search");
+    static UpstreamMetrics price  = makeUpstreamMetrics("priceoverview");
+    static UpstreamMetrics other  = makeUpstreamMetrics("other");
+
+    UpstreamMetrics& m = url.find("/market/search/render") != std::string::npos ? search
+                       : url.find("/market/priceoverview") != std::string::npos ? price
+                       : other;
+
+    curl_off_t totalUs = 0;
+    curl_off_t bytes   = 0;
+    long       status  = 0;
+    curl_easy_getinfo(h, CURLINFO_TOTAL_TIME_T,    &totalUs);
+    curl_easy_getinfo(h, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+    curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE,   &status);
+
+    m.latency.observe(static_cast<double>(totalUs) / 1e6);
+    m.responses.inc(result == CURLE_OK ? static_cast<int>(status) : 0);
+    m.bytes.inc(static_cast<uint64_t>(std::max<curl_off_t>(bytes, 0)));
+}
+
+std::string describeFailure(const FetchResult& result) {
+    if (result.rejected)
+        return upstreamBreaker().isOpen() ? "not sent: Steam circuit breaker is open"
+                                          : "not sent: Steam request queue is full";
+    if (result.status == 0)
+        return "no response from Steam";
+    std::string text = "Steam returned HTTP " + std::to_string(result.status);
+    if (result.retryAfter.count() > 0)
+        text += " (retry after " + std::to_string(result.retryAfter.count()) + "s)";
+    return text;
+}
+
+// ─── Upstream Reactor ──────────────────────────────────────
+
+namespace {
+
+struct Transfer {
+    std::string                           url;
+    FetchResult                           result;
+    FetchCallback                         done;
+    FetchPriority                         priority;
+    std::chrono::steady_clock::time_point deadline;       // latest start
+    bool                                  probe = false;  // the half-open breaker's probe
+};
+
+// Feeds one finished transfer to the limiter's pacing and the breaker.
+void recordOutcome(const Transfer& t) {
+    const FetchResult& result = t.result;
+    if (result.status == 429) {
+        steamLimiter().throttled(result.retryAfter);
+        upstreamBreaker().failed(result.retryAfter, t.probe);
+    } else if (result.status == 0 || result.status >= 500) {
+        upstreamBreaker().failed(result.retryAfter, t.probe);
+    } else {
+        steamLimiter().succeeded();
+        upstreamBreaker().succeeded(t.probe);
+    }
+}
+
+// One thread driving one curl_multi handle for every upstream transfer in
+// the process. Queued transfers start as soon as the Steam limiter grants
+// a token and the in-flight cap allows, interactive ones first;
+// completions are reported from this thread. fetchAsync() and
+// promoteFetch() wake the loop through curl_multi_wakeup(). stop() joins
+// the thread; transfers still queued or running then are dropped without
+// calling back.
+class UpstreamReactor {
+public:
+    UpstreamReactor(int maxInFlight, std::chrono::milliseconds interactiveWait,
+                    std::chrono::milliseconds backgroundWait, double backgroundReserve)
+        : maxInFlight_(std::max(1, maxInFlight)),
+          maxWait_{interactiveWait, backgroundWait},
+          reserve_(std::max(0.0, backgroundReserve)),
+          multi_(curl_multi_init()) {
+        metrics().gauge("cs_skin_upstream_inflight", "Steam transfers in progress", "",
+                        [this]() { return static_cast<double>(inFlight_.load()); });
+        for (FetchPriority p : {FetchPriority::Interactive, FetchPriority::Background}) {
+            metrics().gauge("cs_skin_upstream_queued", "Steam transfers waiting for a limiter token",
+                            std::string("priority=\"") + priorityName(p) + "\"",
+                            [this, p]() { return static_cast<double>(queued_[index(p)].load()); });
+        }
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    void fetch(std::string url, FetchCallback done, FetchPriority priority) {
+        auto* t = new Transfer{std::move(url), {}, std::move(done), priority,
+                               std::chrono::steady_clock::now() + maxWait_[index(priority)]};
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                delete t;
+                return;
+            }
+            incoming_.push_back(t);
+        }
+        queued_[index(priority)]++;
+        curl_multi_wakeup(multi_);
+    }
+
+    void promote(std::string url) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            promotions_.emplace_back(std::move(url), std::chrono::steady_clock::now());
+        }
+        curl_multi_wakeup(multi_);
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) return;
+            stopping_ = true;
+        }
+        curl_multi_wakeup(multi_);
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+private:
+    using Queue     = std::deque<Transfer*>;
+    using Promotion = std::pair<std::string, std::chrono::steady_clock::time_point>;
+
+    static size_t index(FetchPriority p) { return p == FetchPriority::Interactive ? 0 : 1; }
+
+    static const char* priorityName(FetchPriority p) {
+        return p == FetchPriority::Interactive ? "interactive" : "background";
+    }
+
+    void run() {
+        Queue waiting[2];
+        int   running = 0;
+
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stopping_) break;
+                for (Transfer* t : incoming_)
+                    waiting[index(t->priority)].push_back(t);
+                incoming_.clear();
+                applyPromotions(waiting);
+            }
+
+            startWaiting(waiting);
+
+            curl_multi_perform(multi_, &running);
+
+            CURLMsg* msg;
+            int      left;
+            while ((msg = curl_multi_info_read(multi_, &left))) {
+                if (msg->msg != CURLMSG_DONE) continue;
+
+                CURL*     h = msg->easy_handle;
+                Transfer* t = nullptr;
+                curl_easy_getinfo(h, CURLINFO_PRIVATE, &t);
+                recordTransfer(h, t->url, msg->data.result);
+
+                if (msg->data.result == CURLE_OK) {
+                    curl_off_t retryAfter = 0;
+                    curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &t->result.status);
+                    curl_easy_getinfo(h, CURLINFO_RETRY_AFTER,   &retryAfter);
+                    t->result.retryAfter = std::chrono::seconds(std::max<curl_off_t>(retryAfter, 0));
+                } else {
+                    LOG_WARN("reactor") << "CURL error: " << curl_easy_strerror(msg->data.result)
+                                        << " | URL: " << t->url;
+                    t->result.status = 0;
+                    t->result.body.clear();
+                }
+                recordOutcome(*t);
+
+                curl_multi_remove_handle(multi_, h);
+                active_.erase(std::find(active_.begin(), active_.end(), h));
+                curlPool().release(h);
+                inFlight_--;
+                complete(t);
+            }
+
+            // Sleep until socket activity, a wakeup, or the next token
+            int waitMs = 1000;
+            if ((!waiting[0].empty() || !waiting[1].empty()) && inFlight_ < maxInFlight_)
+                waitMs = static_cast<int>(std::min<long long>(100, steamLimiter().timeUntilNext().count()));
+            curl_multi_poll(multi_, nullptr, 0, std::max(waitMs, 1), nullptr);
+        }
+
+        drop(waiting);
+    }
+
+    // Discards every transfer the reactor still holds, at shutdown. Their
+    // callbacks would only start work the process is no longer running.
+    void drop(Queue* waiting) {
+        std::vector<Transfer*> dropped;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dropped.swap(incoming_);
+        }
+        for (size_t q = 0; q < 2; q++)
+            dropped.insert(dropped.end(), waiting[q].begin(), waiting[q].end());
+
+        for (CURL* h : active_) {
+            Transfer* t = nullptr;
+            curl_easy_getinfo(h, CURLINFO_PRIVATE, &t);
+            curl_multi_remove_handle(multi_, h);
+            curlPool().release(h);
+            dropped.push_back(t);
+        }
+        active_.clear();
+
+        for (Transfer* t : dropped)
+            delete t;
+        if (!dropped.empty())
+            LOG_INFO("reactor") << "Dropped " << dropped.size() << " Steam transfers at shutdown";
+    }
+
+    // Moves promoted URLs from the background queue to the back of the
+    // interactive one. A promotion is kept for a second in case the
+    // transfer it names has not been queued yet. Caller holds mutex_.
+    void applyPromotions(Queue* waiting) {
+        if (promotions_.empty()) return;
+        auto now = std::chrono::steady_clock::now();
+
+        auto& background = waiting[1];
+        for (auto it = background.begin(); it != background.end();) {
+            Transfer* t     = *it;
+            auto      match = std::find_if(promotions_.begin(), promotions_.end(),
+                                           [&](const Promotion& p) { return p.first == t->url; });
+            if (match == promotions_.end()) {
+                ++it;
+                continue;
+            }
+            t->priority = FetchPriority::Interactive;
+            t->deadline = std::max(t->deadline, now + maxWait_[0]);
+            waiting[0].push_back(t);
+            queued_[1]--;
+            queued_[0]++;
+            it = background.erase(it);
+        }
+
+        promotions_.erase(std::remove_if(promotions_.begin(), promotions_.end(),
+                                         [&](const Promotion& p) { return now - p.second > std::chrono::seconds(1); }),
+                          promotions_.end());
+    }
+
+    // Starts as many queued transfers as the breaker, the limiter and the
+    // in-flight cap allow, interactive first, and rejects those that can no
+    // longer start in time. Background transfers wait while any
+    // interactive one does, and leave `reserve_` tokens in the bucket.
+    void startWaiting(Queue* waiting) {
+        auto now     = std::chrono::steady_clock::now();
+        auto startBy = now + steamLimiter().timeUntilNext();
+        bool open    = upstreamBreaker().isOpen();
+
+        // Fail fast rather than queue behind a refusing or paused Steam
+        for (size_t q = 0; q < 2; q++) {
+            for (auto it = waiting[q].begin(); it != waiting[q].end();) {
+                if (!open && startBy <= (*it)->deadline) {
+                    ++it;
+                    continue;
+                }
+                queued_[q]--;
+                reject(*it);
+                it = waiting[q].erase(it);
+            }
+        }
+
+        for (size_t q = 0; q < 2; q++) {
+            if (q == 1 && !waiting[0].empty()) return;
+
+            while (!waiting[q].empty()) {
+                if (inFlight_ >= maxInFlight_) return;
+                if (q == 1 && steamLimiter().available() < reserve_ + 1.0) return;
+                if (!steamLimiter().tryAcquire()) return;
+
+                Transfer* t = waiting[q].front();
+                waiting[q].pop_front();
+                queued_[q]--;
+                if (!upstreamBreaker().allow(&t->probe)) {   // half-open: the probe is out
+                    reject(t);
+                    continue;
+                }
+                start(t);
+            }
+        }
+    }
+
+    void start(Transfer* t) {
+        CURL* h = curlPool().acquire();
+        if (!h) {
+            LOG_WARN("reactor") << "Failed to init CURL | URL: " << t->url;
+            recordOutcome(*t);   // a probe must still report back
+            complete(t);
+            return;
+        }
+        curl_easy_setopt(h, CURLOPT_URL,       t->url.c_str());
+        curl_easy_setopt(h, CURLOPT_WRITEDATA, &t->result.body);
+        curl_easy_setopt(h, CURLOPT_PRIVATE,   t);
+        curl_multi_add_handle(multi_, h);
+        active_.push_back(h);
+        inFlight_++;
+    }
+
+    void reject(Transfer* t) {
+        static Counter& rejected = metrics().counter(
+            "cs_skin_upstream_rejected_total",
+            "Steam transfers not sent because the breaker was open or the queue wait ran out");
+        rejected.inc();
+        upstreamBreaker().rejected();
+        t->result.rejected = true;
+        complete(t);
+    }
+
+    // Callbacks must not throw; one that does would take the reactor down.
+    void complete(Transfer* t) {
+        std::unique_ptr<Transfer> owned(t);
+        try {
+            owned->done(owned->result);
+        } catch (const std::exception& e) {
+            LOG_ERROR("reactor") << "Fetch callback threw: " << e.what() << " | URL: " << owned->url;
+        }
+    }
+
+    int                       maxInFlight_;
+    std::chrono::milliseconds maxWait_[2];   // by queue: interactive, background
+    double                    reserve_;
+    CURLM*                    multi_;
+    std::vector<CURL*>        active_;   // added to multi_; reactor thread only
+
+    std::mutex             mutex_;
+    std::vector<Transfer*> incoming_;
+    std::vector<Promotion> promotions_;   // URL, when requested
+
+    bool                   stopping_ = false;
+    std::thread            thread_;
+
+    std::atomic<int> inFlight_{0};
+    std::atomic<int> queued_[2] = {};
+};
+
+UpstreamReactor& upstreamReactor() {
+    // Leaked: completion callbacks may reference it while statics are
+    // destroyed; stopUpstream() joins its thread first
+    static UpstreamReactor* reactor = new UpstreamReactor(
+        envInt("SKIN_UPSTREAM_MAX_INFLIGHT", 32),
+        std::chrono::milliseconds(envInt("SKIN_UPSTREAM_MAX_WAIT_MS", 10000)),
+        std::chrono::milliseconds(envInt("SKIN_UPSTREAM_BACKGROUND_MAX_WAIT_MS", 60000)),
+        static_cast<double>(envInt("SKIN_UPSTREAM_BACKGROUND_RESERVE", steamLimiter().burst() / 2)));
+    return *reactor;
+}
+
+} // namespace
+
+void fetchAsync(std::string url, FetchCallback done, FetchPriority priority) {
+    upstreamReactor().fetch(std::move(url), std::move(done), priority);
+}
+
+void promoteFetch(std::string url) {
+    upstreamReactor().promote(std::move(url));
+}
+
+void stopUpstream() {
+    upstreamReactor().stop();
+}
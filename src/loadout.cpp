@@ -0,0 +1,207 @@
+#include "loadout.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace {
+
+// Combinations of one half of the slots. Picks are stored flat, `width`
+// candidate indices per combination, to avoid a vector per combo.
+struct HalfCombos {
+    size_t                 width = 0;
+    std::vector<int>       picks;
+    std::vector<long long> price;
+    std::vector<long long> value;
+
+    size_t size() const { return price.size(); }
+};
+
+// The candidates in `order` that fewer than `k` others dominate, sorted by
+// price. Ties are broken by index, so of several identical candidates the
+// first k stay.
+template <typename Price, typename Value>
+std::vector<size_t> kFrontier(std::vector<size_t> order, Price price, Value value, int k) {
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (price(a) != price(b)) return price(a) < price(b);
+        if (value(a) != value(b)) return value(a) > value(b);
+        return a < b;
+    });
+
+    // Everything earlier in `order` costs no more and, at the same price,
+    // is worth no less; a candidate is dominated k times once k earlier
+    // ones are worth at least as much. `top` holds the k best values seen.
+    std::vector<size_t> kept;
+    std::priority_queue<long long, std::vector<long long>, std::greater<long long>> top;
+    for (size_t i : order) {
+        long long v = value(i);
+        if (static_cast<int>(top.size()) < k || v > top.top())
+            kept.push_back(i);
+        top.push(v);
+        if (static_cast<int>(top.size()) > k) top.pop();
+    }
+    return kept;
+}
+
+void enumerate(
+    const std::vector<std::vector<SlotCandidate>>& slots,
+    const std::vector<std::vector<size_t>>&        kept,
+    size_t                                         first,
+    size_t                                         last,
+    long long                                      cap,
+    HalfCombos&                                    out
+) {
+    out.width = last - first;
+    std::vector<int> stack(out.width);
+
+    // Depth-first over the half's slots, pruning any prefix already over cap
+    auto walk = [&](auto&& self, size_t depth, long long price, long long value) -> void {
+        if (depth == out.width) {
+            out.picks.insert(out.picks.end(), stack.begin(), stack.end());
+            out.price.push_back(price);
+            out.value.push_back(value);
+            return;
+        }
+        const auto& slot = slots[first + depth];
+        for (size_t i : kept[first + depth]) {
+            if (price + slot[i].price > cap) break;  // kept is sorted by price
+            stack[depth] = static_cast<int>(i);
+            self(self, depth + 1, price + slot[i].price, value + slot[i].value);
+        }
+    };
+    walk(walk, 0, 0, 0);
+}
+
+} // namespace
+
+std::vector<LoadoutPick> optimizeLoadouts(
+    const std::vector<std::vector<SlotCandidate>>& slots,
+    long long                                      cap,
+    int                                            k,
+    LoadoutStats*                                  stats
+) {
+    LoadoutStats st;
+    std::vector<LoadoutPick> result;
+    const size_t m = slots.size();
+
+    if (m == 0 || k <= 0 || cap <= 0) {
+        if (stats) *stats = st;
+        return result;
+    }
+
+    // Cheapest usable candidate per slot bounds what every other slot may spend
+    std::vector<long long> minPrice(m, -1);
+    long long              minTotal = 0;
+    for (size_t s = 0; s < m; s++) {
+        st.candidates += slots[s].size();
+        for (const auto& c : slots[s])
+            if (c.price > 0 && (minPrice[s] < 0 || c.price < minPrice[s]))
+                minPrice[s] = c.price;
+        if (minPrice[s] < 0) {
+            if (stats) *stats = st;
+            return result;  // a slot with no candidates makes every loadout incomplete
+        }
+        minTotal += minPrice[s];
+    }
+    if (minTotal > cap) {
+        if (stats) *stats = st;
+        return result;
+    }
+
+    std::vector<std::vector<size_t>> kept(m);
+    for (size_t s = 0; s < m; s++) {
+        const auto& slot = slots[s];
+        long long   room = cap - (minTotal - minPrice[s]);
+
+        std::vector<size_t> fits;
+        for (size_t i = 0; i < slot.size(); i++)
+            if (slot[i].price > 0 && slot[i].price <= room)
+                fits.push_back(i);
+        kept[s] = kFrontier(std::move(fits),
+                            [&](size_t i) { return slot[i].price; },
+                            [&](size_t i) { return slot[i].value; }, k);
+        st.kept += kept[s].size();
+    }
+
+    // Split into two halves: enumerate A fully, prune B like a slot
+    size_t     mid = (m + 1) / 2;
+    HalfCombos a, b;
+    enumerate(slots, kept, 0,   mid, cap, a);
+    enumerate(slots, kept, mid, m,   cap, b);
+    st.combos = a.size() + b.size();
+
+    std::vector<size_t> bAll(b.size());
+    for (size_t i = 0; i < bAll.size(); i++) bAll[i] = i;
+    std::vector<size_t> bList = kFrontier(std::move(bAll),
+                                          [&](size_t i) { return b.price[i]; },
+                                          [&](size_t i) { return b.value[i]; }, k);
+    std::vector<long long> bPrice(bList.size());
+    for (size_t j = 0; j < bList.size(); j++) bPrice[j] = b.price[bList[j]];
+
+    // Sparse table over bList: best[l][j] is the position of the most
+    // valuable entry in [j, j + 2^l), the cheaper one on ties
+    auto better = [&](size_t x, size_t y) { return b.value[bList[y]] > b.value[bList[x]] ? y : x; };
+    std::vector<std::vector<size_t>> best(1);
+    for (size_t j = 0; j < bList.size(); j++) best[0].push_back(j);
+    for (size_t len = 2; len <= bList.size(); len *= 2) {
+        const auto& prev = best.back();
+        std::vector<size_t> next(bList.size() - len + 1);
+        for (size_t j = 0; j < next.size(); j++)
+            next[j] = better(prev[j], prev[j + len / 2]);
+        best.push_back(std::move(next));
+    }
+    auto bestIn = [&](size_t lo, size_t hi) {   // inclusive
+        size_t l = 0;
+        while ((size_t(2) << l) <= hi - lo + 1) l++;
+        return better(best[l][lo], best[l][hi + 1 - (size_t(1) << l)]);
+    };
+
+    // Max-heap of (combined value, A combo, range of bList, its best entry).
+    // Popping a node yields A paired with entry j; the rest of the range is
+    // split into [lo, j) and (j, hi], each seeded with its own best entry.
+    struct Node {
+        long long value;
+        long long price;
+        size_t    ai;
+        size_t    lo;
+        size_t    hi;
+        size_t    j;
+        bool operator<(const Node& o) const {
+            if (value != o.value) return value < o.value;
+            return price > o.price;  // prefer cheaper on ties
+        }
+    };
+    auto node = [&](size_t ai, size_t lo, size_t hi) {
+        size_t j = bestIn(lo, hi);
+        return Node{a.value[ai] + b.value[bList[j]], a.price[ai] + bPrice[j], ai, lo, hi, j};
+    };
+
+    std::vector<Node> seeds;
+    seeds.reserve(a.size());
+    for (size_t i = 0; i < a.size(); i++) {
+        long long room = cap - a.price[i];
+        auto it = std::upper_bound(bPrice.begin(), bPrice.end(), room);
+        if (it == bPrice.begin()) continue;
+        seeds.push_back(node(i, 0, static_cast<size_t>(it - bPrice.begin()) - 1));
+    }
+    std::priority_queue<Node> heap(std::less<Node>(), std::move(seeds));
+
+    while (!heap.empty() && static_cast<int>(result.size()) < k) {
+        Node top = heap.top();
+        heap.pop();
+
+        LoadoutPick pick;
+        pick.price = top.price;
+        pick.value = top.value;
+        pick.choice.reserve(m);
+        size_t bi = bList[top.j];
+        for (size_t s = 0; s < a.width; s++) pick.choice.push_back(a.picks[top.ai * a.width + s]);
+        for (size_t s = 0; s < b.width; s++) pick.choice.push_back(b.picks[bi * b.width + s]);
+        result.push_back(std::move(pick));
+
+        if (top.j > top.lo) heap.push(node(top.ai, top.lo, top.j - 1));
+        if (top.j < top.hi) heap.push(node(top.ai, top.j + 1, top.hi));
+    }
+
+    if (stats) *stats = st;
+    return result;
+}
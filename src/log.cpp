@@ -0,0 +1,126 @@
+#include "log.h"
+#include "config.h"
+#include "metrics.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static int levelFromEnv() {
+    std::string v = envString("SKIN_LOG_LEVEL", "info");
+    if (v == "debug") return static_cast<int>(LogLevel::Debug);
+    if (v == "warn")  return static_cast<int>(LogLevel::Warn);
+    if (v == "error") return static_cast<int>(LogLevel::Error);
+    if (v == "off")   return static_cast<int>(LogLevel::Off);
+    return static_cast<int>(LogLevel::Info);
+}
+
+std::atomic<int> currentLogLevel{levelFromEnv()};
+
+void setLogLevel(LogLevel level) {
+    currentLogLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+// Queue of formatted lines drained by one writer thread.
+class LogWriter {
+public:
+    LogWriter() : thread_([this]() { run(); }) { thread_.detach(); }
+
+    void push(std::string line) {
+        static Counter& dropped = metrics().counter(
+            "cs_skin_log_dropped_total", "Log lines dropped because the log queue was full");
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.size() >= MAX_PENDING) {
+                dropped.inc();
+                return;
+            }
+            pending_.push_back(std::move(line));
+            queued_++;
+        }
+        wake_.notify_one();
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        unsigned long long target = queued_;
+        written_cv_.wait(lock, [&]() { return written_ >= target; });
+    }
+
+private:
+    static constexpr size_t MAX_PENDING = 8192;
+
+    void run() {
+        std::vector<std::string> batch;
+        std::string              out;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this]() { return !pending_.empty(); });
+                batch.swap(pending_);
+            }
+
+            out.clear();
+            for (const auto& line : batch)
+                out += line;
+            std::fwrite(out.data(), 1, out.size(), stderr);
+            std::fflush(stderr);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                written_ += batch.size();
+            }
+            written_cv_.notify_all();
+            batch.clear();
+        }
+    }
+
+    std::mutex               mutex_;
+    std::condition_variable  wake_;
+    std::condition_variable  written_cv_;
+    std::vector<std::string> pending_;
+    unsigned long long       queued_  = 0;
+    unsigned long long       written_ = 0;
+    std::thread              thread_;
+};
+
+static LogWriter& logWriter() {
+    // Leaked, with a detached thread: lines may be logged during shutdown
+    static LogWriter* writer = new LogWriter();
+    return *writer;
+}
+
+void flushLogs() {
+    logWriter().flush();
+}
+
+LogLine::LogLine(LogLevel level, const char* tag) {
+    static const char* NAMES[] = {"DEBUG", "INFO ", "WARN ", "ERROR"};
+
+    auto   now  = std::chrono::system_clock::now();
+    auto   secs = std::chrono::system_clock::to_time_t(now);
+    auto   ms   = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    std::tm tm{};
+#ifdef _WIN32
+    gmtime_s(&tm, &secs);
+#else
+    gmtime_r(&secs, &tm);
+#endif
+
+    // Room for every int the format could print, not just real dates
+    char stamp[96];
+    std::snprintf(stamp, sizeof(stamp), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                  tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(ms));
+
+    out_ << stamp << ' ' << NAMES[static_cast<int>(level)] << " [" << tag << "] ";
+}
+
+LogLine::~LogLine() {
+    out_ << '\n';
+    logWriter().push(out_.str());
+}
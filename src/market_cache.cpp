@@ -0,0 +1,134 @@
+#include "market_cache.h"
+#include "config.h"
+
+std::string PageKey::str() const {
+    // Unit separator keeps "a b" + "c" distinct from "a" + "b c"
+    return query + '\x1f' + sortCol + '\x1f' + sortDir + '\x1f' + std::to_string(start);
+}
+
+MarketCache::MarketCache(std::chrono::seconds ttl, size_t maxPages)
+    : ttl_(ttl), maxPages_(maxPages) {}
+
+CacheLookup MarketCache::lookup(const PageKey& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = entries_.find(key.str());
+    if (it == entries_.end()) {
+        misses_++;
+        return {nullptr, CacheState::Miss};
+    }
+
+    Entry& e   = it->second;
+    lru_.splice(lru_.begin(), lru_, e.lru);
+
+    auto   age = Clock::now() - e.fetchedAt;
+    double ageSeconds = std::chrono::duration<double>(age).count();
+    if (age < ttl_) {
+        hits_++;
+        return {e.page, CacheState::Hit, false, ageSeconds};
+    }
+
+    stale_++;
+    bool claimed = !e.refreshing;
+    if (claimed) {
+        e.refreshing = true;
+        refreshes_++;
+    }
+    return {e.page, CacheState::Stale, claimed, ageSeconds};
+}
+
+void MarketCache::store(const PageKey& key, SkinPage page) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::string k  = key.str();
+    auto        it = entries_.find(k);
+    if (it == entries_.end()) {
+        if (entries_.size() >= maxPages_)
+            evictLocked();
+        it = entries_.emplace(k, Entry{}).first;
+        lru_.push_front(k);
+        it->second.lru = lru_.begin();
+    } else {
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+    }
+
+    Entry& e     = it->second;
+    e.key        = key;
+    e.page       = std::move(page);
+    e.fetchedAt  = Clock::now();
+    e.refreshing = false;
+    generation_++;
+}
+
+std::vector<CachedPage> MarketCache::dump() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Cache ages are kept on the steady clock; snapshots need wall time
+    auto steadyNow = Clock::now();
+    auto wallNow   = std::chrono::system_clock::now();
+
+    std::vector<CachedPage> out;
+    out.reserve(entries_.size());
+    for (const auto& [k, e] : entries_) {
+        auto age = std::chrono::duration_cast<std::chrono::system_clock::duration>(steadyNow - e.fetchedAt);
+        out.push_back({e.key, e.page, wallNow - age});
+    }
+    return out;
+}
+
+void MarketCache::restore(const PageKey& key, SkinPage page, std::chrono::seconds age) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Never displace live pages for snapshot data
+    std::string k = key.str();
+    if (entries_.count(k) || entries_.size() >= maxPages_) return;
+
+    // Restored pages have not been read yet, so they go to the cold end
+    Entry& e    = entries_[k];
+    e.key       = key;
+    e.page      = std::move(page);
+    e.fetchedAt = Clock::now() - age;
+    e.lru       = lru_.insert(lru_.end(), k);
+}
+
+void MarketCache::releaseRefresh(const PageKey& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key.str());
+    if (it != entries_.end())
+        it->second.refreshing = false;
+}
+
+CacheStats MarketCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {
+        hits_.load(),
+        misses_.load(),
+        stale_.load(),
+        refreshes_.load(),
+        evictions_.load(),
+        entries_.size(),
+        static_cast<int>(ttl_.count())
+    };
+}
+
+// Drops the least recently used page. Pages being refreshed are skipped,
+// since their refresh would store them straight back.
+void MarketCache::evictLocked() {
+    for (auto at = lru_.end(); at != lru_.begin();) {
+        --at;
+        auto it = entries_.find(*at);
+        if (it->second.refreshing) continue;
+        entries_.erase(it);
+        lru_.erase(at);
+        evictions_++;
+        return;
+    }
+}
+
+MarketCache& marketCache() {
+    static MarketCache cache(
+        std::chrono::seconds(envInt("SKIN_CACHE_TTL_SEC", 300)),
+        static_cast<size_t>(envInt("SKIN_CACHE_MAX_PAGES", 4096))
+    );
+    return cache;
+}
@@ -0,0 +1,368 @@
+#include "market_fetch.h"
+#include "config.h"
+#include "log.h"
+#include "metrics.h"
+#include "price_history.h"
+#include "search_index.h"
+#include "singleflight.h"
+#include "steam_parser.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+const std::string& steamBaseURL() {
+    static const std::string base = [] {
+        std::string url = envString("SKIN_STEAM_BASE_URL", "https://steamcommunity.com");
+        while (!url.empty() && url.back() == '/') url.pop_back();
+        return url;
+    }();
+    return base;
+}
+
+std::string searchPageURL(const PageKey& key) {
+    return
+        steamBaseURL() + "/market/search/render/?appid=730"
+        "&search_descriptions=0&norender=1"
+        "&count=10"
+        "&start="       + std::to_string(key.start) +
+        "&sort_column=" + key.sortCol               +
+        "&sort_dir="    + key.sortDir               +
+        "&query="       + urlEncode(key.query);
+}
+
+std::string priceOverviewURL(const std::string& hashName) {
+    return steamBaseURL() + "/market/priceoverview/?appid=730&currency=1"
+                            "&market_hash_name=" + urlEncode(hashName);
+}
+
+std::optional<std::vector<Skin>> parsePage(const PageKey& key, const std::string& raw) {
+    if (raw.empty()) {
+        LOG_WARN("parsePage") << "Empty response for: " << key.query;
+        return std::nullopt;
+    }
+
+    // Steam sometimes returns HTML error pages instead of JSON
+    if (raw.front() != '{' && raw.front() != '[') {
+        LOG_WARN("parsePage") << "Non-JSON response (" << raw.length()
+                              << " bytes) for: " << key.query;
+        return std::nullopt;
+    }
+
+    static Histogram& parseLatency = metrics().histogram(
+        "cs_skin_parse_duration_seconds", "Time to parse one Steam search page");
+
+    auto        began = std::chrono::steady_clock::now();
+    std::string error;
+    auto        page  = parseSearchPage(raw, &error);
+    parseLatency.observe(secondsSince(began));
+    if (!page) {
+        LOG_WARN("parsePage") << error << " | query: " << key.query;
+        return std::nullopt;
+    }
+
+    priceHistory().recordPage(*page, std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    LOG_DEBUG("parsePage") << "Parsed " << page->size() << " skins for: " << key.query
+                           << " | start=" << key.start << " | sort=" << key.sortCol;
+    return page;
+}
+
+// In-flight page fetches keyed on the final Steam URL. Concurrent requests
+// for the same page (e.g. every /loadout/build for one side) share a single
+// upstream call and its parsed result.
+static SingleFlight<std::vector<Skin>> pageFlights;
+
+static PageTransport& pageTransport() {
+    static PageTransport transport = [](const std::vector<std::string>& urls, FetchPriority priority,
+                                        const FetchDone& onDone) {
+        for (size_t i = 0; i < urls.size(); i++)
+            fetchAsync(urls[i], [onDone, i](const FetchResult& result) { onDone(i, result); }, priority);
+    };
+    return transport;
+}
+
+void setPageTransport(PageTransport transport) {
+    pageTransport() = std::move(transport);
+}
+
+long long coalescedPageFetches() {
+    return pageFlights.followers();
+}
+
+namespace {
+
+// One loadPagesAsync() call, completed by whichever thread delivers its
+// last page.
+struct PageBatch {
+    std::vector<PageKey>     keys;
+    std::vector<std::string> urls;
+    std::vector<SkinPage>    pages;
+    PageSink                 sink;
+    PagesDone                done;
+
+    std::mutex mutex;
+    size_t     remaining = 0;
+
+    void deliver(size_t i, const SkinPage& page) {
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pages[i] = page;
+            if (sink) sink(i, page);
+            last = --remaining == 0;
+        }
+        if (last) done(std::move(pages));
+    }
+};
+
+} // namespace
+
+void loadPagesAsync(const std::vector<PageKey>& keys, PageSink sink, PagesDone done, FetchPriority priority) {
+    if (keys.empty()) {
+        done({});
+        return;
+    }
+
+    auto batch = std::make_shared<PageBatch>();
+    batch->keys      = keys;
+    batch->sink      = std::move(sink);
+    batch->done      = std::move(done);
+    batch->pages.resize(keys.size());
+    batch->remaining = keys.size();
+    batch->urls.reserve(keys.size());
+    for (const auto& k : keys)
+        batch->urls.push_back(searchPageURL(k));
+
+    std::vector<std::string> leadUrls;
+    std::vector<size_t>      leadAt;
+    for (size_t i = 0; i < keys.size(); i++) {
+        bool leader = pageFlights.joinOrWait(batch->urls[i], [batch, i](const SkinPage& page) {
+            batch->deliver(i, page);
+        });
+        if (leader) {
+            leadUrls.push_back(batch->urls[i]);
+            leadAt.push_back(i);
+        } else if (priority == FetchPriority::Interactive) {
+            promoteFetch(batch->urls[i]);   // the leader may be the warmer
+        }
+    }
+    if (leadUrls.empty()) return;
+
+    // Parse and publish each page the moment its transfer completes, so
+    // followers and streaming callers are not held up by slower pages
+    pageTransport()(leadUrls, priority, [batch, leadAt](size_t j, const FetchResult& result) {
+        size_t   i = leadAt[j];
+        SkinPage page;
+
+        std::optional<std::vector<Skin>> parsed;
+        if (result.ok())
+            parsed = parsePage(batch->keys[i], result.body);
+        else if (result.rejected)
+            LOG_DEBUG("loadPages") << describeFailure(result) << " | query: " << batch->keys[i].query;
+        else
+            LOG_WARN("loadPages") << describeFailure(result) << " | query: " << batch->keys[i].query;
+
+        if (parsed) {
+            page = std::make_shared<const std::vector<Skin>>(std::move(*parsed));
+            marketCache().store(batch->keys[i], page);
+            searchIndex().add(*page, batch->keys[i].query);
+        }
+        pageFlights.finish(batch->urls[i], page);
+        batch->deliver(i, page);
+    });
+}
+
+std::vector<SkinPage> loadPages(const std::vector<PageKey>& keys, const PageSink& sink, FetchPriority priority) {
+    struct Waiter {
+        std::mutex                                mutex;
+        std::condition_variable                   ready;
+        std::deque<std::pair<size_t, SkinPage>>   arrived;
+        std::vector<SkinPage>                     pages;
+        bool                                      finished = false;
+    };
+
+    auto waiter = std::make_shared<Waiter>();
+    loadPagesAsync(keys,
+        [waiter](size_t i, const SkinPage& page) {
+            {
+                std::lock_guard<std::mutex> lock(waiter->mutex);
+                waiter->arrived.emplace_back(i, page);
+            }
+            waiter->ready.notify_one();
+        },
+        [waiter](std::vector<SkinPage> pages) {
+            {
+                std::lock_guard<std::mutex> lock(waiter->mutex);
+                waiter->pages    = std::move(pages);
+                waiter->finished = true;
+            }
+            waiter->ready.notify_one();
+        },
+        priority);
+
+    // Hand pages to `sink` on this thread as they arrive
+    std::unique_lock<std::mutex> lock(waiter->mutex);
+    for (;;) {
+        waiter->ready.wait(lock, [&]() { return waiter->finished || !waiter->arrived.empty(); });
+        if (waiter->arrived.empty()) break;
+
+        auto next = std::move(waiter->arrived.front());
+        waiter->arrived.pop_front();
+        lock.unlock();
+        if (sink) sink(next.first, next.second);
+        lock.lock();
+    }
+    return std::move(waiter->pages);
+}
+
+void refreshPageAsync(const PageKey& key) {
+    loadPagesAsync({key}, nullptr, [key](std::vector<SkinPage> pages) {
+        if (!pages[0])
+            marketCache().releaseRefresh(key);
+    }, FetchPriority::Background);
+}
+
+void appendPage(
+    const SkinPage&            page,
+    int                        min_cents,
+    int                        max_cents,
+    std::vector<Skin>&         skins,
+    std::unordered_set<StrId>& seen
+) {
+    if (!page) return;
+    for (const auto& s : *page) {
+        if (s.price_cents < min_cents || s.price_cents > max_cents) continue;
+        if (!seen.insert(s.hash_name).second) continue;
+        skins.push_back(s);
+    }
+}
+
+void PageFreshness::merge(const PageFreshness& other) {
+    fromSteam += other.fromSteam;
+    stale     += other.stale;
+    missing   += other.missing;
+    ageSeconds = std::max(ageSeconds, other.ageSeconds);
+}
+
+// Builds the popular/price interleave of `query`'s pages, hands cached ones
+// to `sink` and collects the rest (with their interleave positions).
+static PageFreshness splitCachedPages(
+    const std::string&    query,
+    int                   pages,
+    const PageSink&       sink,
+    std::vector<PageKey>& missing,
+    std::vector<size_t>&  missingAt
+) {
+    std::vector<PageKey> keys;
+    for (int p = 0; p < pages; p++) {
+        keys.push_back({query, "popular", "desc", p * 10});
+        keys.push_back({query, "price",   "desc", p * 10});
+    }
+
+    PageFreshness freshness;
+    for (size_t i = 0; i < keys.size(); i++) {
+        CacheLookup hit = marketCache().lookup(keys[i]);
+        if (hit.state == CacheState::Miss) {
+            missing.push_back(keys[i]);
+            missingAt.push_back(i);
+            continue;
+        }
+        if (hit.state == CacheState::Stale) {
+            freshness.stale++;
+            if (hit.refreshClaimed)
+                refreshPageAsync(keys[i]);
+        }
+        freshness.ageSeconds = std::max(freshness.ageSeconds, hit.ageSeconds);
+        if (sink) sink(i, hit.page);
+    }
+    return freshness;
+}
+
+// Counts what Steam delivered for the pages that were not cached.
+static void addFetched(PageFreshness& freshness, const std::vector<SkinPage>& fetched) {
+    for (const auto& page : fetched) {
+        if (page) freshness.fromSteam++;
+        else      freshness.missing++;
+    }
+}
+
+PageFreshness visitQueryPages(const std::string& query, int pages, const PageSink& sink) {
+    std::vector<PageKey> missing;
+    std::vector<size_t>  missingAt;
+    PageFreshness freshness = splitCachedPages(query, pages, sink, missing, missingAt);
+
+    if (!missing.empty())
+        addFetched(freshness, loadPages(missing, [&](size_t j, const SkinPage& page) {
+            if (sink) sink(missingAt[j], page);
+        }));
+
+    return freshness;
+}
+
+void visitQueryPagesAsync(
+    const std::string&                              query,
+    int                                             pages,
+    PageSink                                        sink,
+    std::function<void(const PageFreshness& pages)> done
+) {
+    std::vector<PageKey> missing;
+    std::vector<size_t>  missingAt;
+    PageFreshness freshness = splitCachedPages(query, pages, sink, missing, missingAt);
+
+    if (missing.empty()) {
+        done(freshness);
+        return;
+    }
+
+    loadPagesAsync(missing,
+        [sink, missingAt](size_t j, const SkinPage& page) { if (sink) sink(missingAt[j], page); },
+        [done, freshness](std::vector<SkinPage> fetched) mutable {
+            addFetched(freshness, fetched);
+            done(freshness);
+        });
+}
+
+void fetchQuery(
+    const std::string&                                                      query,
+    int                                                                     pages,
+    int                                                                     min_cents,
+    int                                                                     max_cents,
+    std::function<void(std::vector<Skin> skins, const PageFreshness& pages)> done
+) {
+    auto found = std::make_shared<std::vector<SkinPage>>(static_cast<size_t>(pages) * 2);
+    visitQueryPagesAsync(query, pages,
+        [found](size_t i, const SkinPage& page) { (*found)[i] = page; },
+        [found, query, min_cents, max_cents, done](const PageFreshness& freshness) {
+            std::vector<Skin>         skins;
+            std::unordered_set<StrId> seen;
+            for (const auto& page : *found)
+                appendPage(page, min_cents, max_cents, skins, seen);
+
+            LOG_DEBUG("fetchQuery") << query << " | " << found->size() << " pages, "
+                                    << freshness.fromSteam << " from Steam, " << freshness.stale
+                                    << " stale, " << freshness.missing << " missing, "
+                                    << skins.size() << " skins";
+            done(std::move(skins), freshness);
+        });
+}
+
+WarmResult warmQuery(const std::string& query, int pages) {
+    std::vector<PageKey> keys;
+    for (int p = 0; p < pages; p++) {
+        keys.push_back({query, "popular", "desc", p * 10});
+        keys.push_back({query, "price",   "desc", p * 10});
+    }
+
+    WarmResult r;
+    r.pagesTotal = static_cast<int>(keys.size());
+    for (const auto& page : loadPages(keys, nullptr, FetchPriority::Background)) {
+        if (!page) continue;
+        r.pagesOk++;
+        r.items += static_cast<int>(page->size());
+    }
+    return r;
+}
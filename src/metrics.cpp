@@ -0,0 +1,179 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+
+size_t nextMetricStripe() {
+    static std::atomic<size_t> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed) % METRIC_STRIPES;
+}
+
+uint64_t Counter::value() const {
+    uint64_t sum = 0;
+    for (const auto& s : slots_)
+        sum += s.v.load(std::memory_order_relaxed);
+    return sum;
+}
+
+const double Histogram::BOUNDS[Histogram::BUCKETS] = {
+    0.00001, 0.00002, 0.00005,
+    0.0001,  0.0002,  0.0005,
+    0.001,   0.002,   0.005,
+    0.01,    0.02,    0.05,
+    0.1,     0.2,     0.5,
+    1.0,     2.0,     5.0,
+    10.0,    20.0,    50.0,
+};
+
+void Histogram::observe(double seconds) {
+    if (seconds < 0) seconds = 0;
+    size_t bucket = static_cast<size_t>(
+        std::lower_bound(BOUNDS, BOUNDS + BUCKETS, seconds) - BOUNDS);
+
+    Stripe& s = stripes_[metricStripe()];
+    s.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    s.sumNs.fetch_add(static_cast<uint64_t>(seconds * 1e9), std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snap;
+    uint64_t sumNs = 0;
+    for (const auto& s : stripes_) {
+        for (size_t b = 0; b <= BUCKETS; b++)
+            snap.counts[b] += s.counts[b].load(std::memory_order_relaxed);
+        sumNs += s.sumNs.load(std::memory_order_relaxed);
+    }
+    for (uint64_t c : snap.counts)
+        snap.count += c;
+    snap.sum = sumNs / 1e9;
+    return snap;
+}
+
+CodeCounters::CodeCounters(std::string name, std::string help, std::string labels)
+    : name_(std::move(name)), help_(std::move(help)), labels_(std::move(labels)) {}
+
+void CodeCounters::inc(int code) {
+    if (code < 0 || code >= static_cast<int>(codes_.size())) code = 0;
+
+    Counter* c = codes_[code].load(std::memory_order_acquire);
+    if (!c) {
+        // Racing first uses resolve to the same registered series
+        std::string labels = labels_ + (labels_.empty() ? "" : ",") + "code=\"" + std::to_string(code) + "\"";
+        c = &metrics().counter(name_, help_, labels);
+        codes_[code].store(c, std::memory_order_release);
+    }
+    c->inc();
+}
+
+// ─── Registry ──────────────────────────────────────────────
+
+MetricsRegistry::Series& MetricsRegistry::seriesLocked(
+    const std::string& name,
+    const std::string& help,
+    Kind               kind,
+    const std::string& labels
+) {
+    Family& f = families_[name];
+    if (f.series.empty()) {
+        f.help = help;
+        f.kind = kind;
+    }
+    for (auto& s : f.series)
+        if (s.labels == labels) return s;
+
+    f.series.emplace_back();
+    f.series.back().labels = labels;
+    return f.series.back();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = seriesLocked(name, help, Kind::Counter, labels);
+    if (!s.counter) s.counter = std::make_unique<Counter>();
+    return *s.counter;
+}
+
+Counter& MetricsRegistry::secondsCounter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = seriesLocked(name, help, Kind::Counter, labels);
+    if (!s.counter) s.counter = std::make_unique<Counter>();
+    s.scale = 1e-9;
+    return *s.counter;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = seriesLocked(name, help, Kind::Histogram, labels);
+    if (!s.histogram) s.histogram = std::make_unique<Histogram>();
+    return *s.histogram;
+}
+
+void MetricsRegistry::gauge(
+    const std::string&      name,
+    const std::string&      help,
+    const std::string&      labels,
+    std::function<double()> read
+) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    seriesLocked(name, help, Kind::Gauge, labels).gauge = std::move(read);
+}
+
+static std::string number(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.10g", v);
+    return buf;
+}
+
+static std::string braced(const std::string& labels, const std::string& extra = "") {
+    std::string inner = labels;
+    if (!extra.empty()) inner += (inner.empty() ? "" : ",") + extra;
+    return inner.empty() ? "" : "{" + inner + "}";
+}
+
+std::string MetricsRegistry::render() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::string out;
+    out.reserve(16384);
+    for (const auto& [name, f] : families_) {
+        static const char* TYPES[] = {"counter", "histogram", "gauge"};
+        out += "# HELP " + name + " " + f.help + "\n";
+        out += "# TYPE " + name + " " + TYPES[static_cast<int>(f.kind)] + "\n";
+
+        for (const auto& s : f.series) {
+            switch (f.kind) {
+            case Kind::Counter:
+                if (s.scale == 1.0)
+                    out += name + braced(s.labels) + " " + std::to_string(s.counter->value()) + "\n";
+                else
+                    out += name + braced(s.labels) + " " + number(s.counter->value() * s.scale) + "\n";
+                break;
+
+            case Kind::Gauge:
+                out += name + braced(s.labels) + " " + number(s.gauge ? s.gauge() : 0.0) + "\n";
+                break;
+
+            case Kind::Histogram: {
+                Histogram::Snapshot snap = s.histogram->snapshot();
+                uint64_t cumulative = 0;
+                for (size_t b = 0; b < Histogram::BUCKETS; b++) {
+                    cumulative += snap.counts[b];
+                    out += name + "_bucket" + braced(s.labels, "le=\"" + number(Histogram::BOUNDS[b]) + "\"") +
+                           " " + std::to_string(cumulative) + "\n";
+                }
+                out += name + "_bucket" + braced(s.labels, "le=\"+Inf\"") + " " + std::to_string(snap.count) + "\n";
+                out += name + "_sum" + braced(s.labels) + " " + number(snap.sum) + "\n";
+                out += name + "_count" + braced(s.labels) + " " + std::to_string(snap.count) + "\n";
+                break;
+            }
+            }
+        }
+    }
+    return out;
+}
+
+MetricsRegistry& metrics() {
+    // Leaked: worker threads may still record while statics are destroyed
+    static MetricsRegistry* registry = new MetricsRegistry();
+    return *registry;
+}
@@ -0,0 +1,58 @@
+#include "price_cache.h"
+#include "config.h"
+
+#include <algorithm>
+
+PriceCache::PriceCache(std::chrono::seconds ttl, size_t maxEntries)
+    : ttl_(ttl), maxEntries_(std::max<size_t>(1, maxEntries)) {}
+
+PriceQuotePtr PriceCache::find(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(name);
+    if (it == index_.end() ||
+        std::chrono::system_clock::now() - it->second->second->fetchedAt > ttl_)
+    {
+        misses_++;
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    hits_++;
+    return it->second->second;
+}
+
+PriceQuotePtr PriceCache::findAny(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(name);
+    return it == index_.end() ? nullptr : it->second->second;
+}
+
+void PriceCache::insert(const std::string& name, PriceQuotePtr quote) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+        it->second->second = std::move(quote);
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    lru_.emplace_front(name, std::move(quote));
+    index_[name] = lru_.begin();
+
+    while (lru_.size() > maxEntries_) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+PriceCacheStats PriceCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {hits_.load(), misses_.load(), index_.size(), static_cast<int>(ttl_.count())};
+}
+
+PriceCache& priceCache() {
+    static PriceCache cache(
+        std::chrono::seconds(envInt("SKIN_PRICE_TTL_SEC", 300)),
+        static_cast<size_t>(envInt("SKIN_PRICE_CACHE_MAX", 50000))
+    );
+    return cache;
+}
@@ -0,0 +1,228 @@
+#include "price_fetch.h"
+#include "config.h"
+#include "http_client.h"
+#include "log.h"
+#include "market_fetch.h"
+#include "price_history.h"
+#include "singleflight.h"
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+
+using json = nlohmann::json;
+
+// In-flight priceoverview fetches keyed on hash name, shared by concurrent
+// batches (and /price) asking for the same item.
+static SingleFlight<PriceQuote> priceFlights;
+
+// Cents from a price text such as "$1,234.56"; 0 if it has no digits.
+static int priceTextCents(const std::string& text) {
+    long long whole    = 0;
+    int       fraction = 0;
+    int       decimals = -1;   // digits seen after the point
+    bool      digits   = false;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            digits = true;
+            if (decimals < 0) {
+                whole = whole * 10 + (c - '0');
+                if (whole > 100000000) return 0;
+            } else if (decimals < 2) {
+                fraction = fraction * 10 + (c - '0');
+                decimals++;
+            }
+        } else if (c == '.' && decimals < 0) {
+            decimals = 0;
+        }
+    }
+    if (!digits) return 0;
+    if (decimals == 1) fraction *= 10;
+    return static_cast<int>(whole * 100 + fraction);
+}
+
+// Parses a priceoverview response. Returns null and sets `error` when the
+// request failed or Steam has no price for the item.
+static PriceQuotePtr parsePriceOverview(const FetchResult& result, std::string* error) {
+    if (!result.ok() || result.body.empty()) {
+        *error = describeFailure(result);
+        return nullptr;
+    }
+
+    // Rate-limited requests can also come back as HTML error pages
+    const std::string& raw = result.body;
+    if (raw.front() != '{') {
+        *error = "Non-JSON response from Steam";
+        return nullptr;
+    }
+
+    try {
+        auto data = json::parse(raw);
+        if (!data.value("success", false)) {
+            *error = "Steam has no price for this item";
+            return nullptr;
+        }
+
+        auto quote       = std::make_shared<PriceQuote>();
+        quote->lowest    = data.value("lowest_price", "N/A");
+        quote->median    = data.value("median_price", "N/A");
+        quote->volume    = data.value("volume", "N/A");
+        quote->fetchedAt = std::chrono::system_clock::now();
+        return quote;
+    } catch (const std::exception& e) {
+        *error = e.what();
+        return nullptr;
+    }
+}
+
+namespace {
+
+// One fetchPrices() call, completed by whichever thread reports its last
+// name. Uncached names wait in `queue` and are looked up at most `window`
+// at a time; each lookup that ends starts the next.
+struct PriceBatch : std::enable_shared_from_this<PriceBatch> {
+    PriceSink                                  sink;
+    std::function<void(PriceBatchStats stats)> done;
+    FetchPriority                              priority = FetchPriority::Interactive;
+
+    std::mutex              mutex;
+    PriceBatchStats         stats;
+    size_t                  remaining = 0;
+    std::deque<std::string> queue;
+    size_t                  window = 1;
+    size_t                  active = 0;   // lookups started and not yet delivered
+
+    void deliver(const PriceResult& result, int PriceBatchStats::*counter) {
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.*counter += 1;
+            sink(result);
+            last = --remaining == 0;
+        }
+        if (last) finish();
+    }
+
+    // A failed fetch: the expired quote if one is still cached, else the error.
+    void deliverFailure(const std::string& name, const std::string& error) {
+        if (PriceQuotePtr old = priceCache().findAny(name))
+            deliver({name, old, "", true, true}, &PriceBatchStats::stale);
+        else
+            deliver({name, nullptr, error, false}, &PriceBatchStats::failed);
+    }
+
+    // Starts queued lookups until the window is full. `ended` releases the
+    // slot of a lookup that just delivered.
+    void pump(bool ended) {
+        for (;;) {
+            std::string name;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (ended) active--;
+                ended = false;
+                if (queue.empty() || active >= window) return;
+                name = std::move(queue.front());
+                queue.pop_front();
+                active++;
+            }
+            // Another request may have fetched it while this one waited
+            if (PriceQuotePtr quote = priceCache().find(name)) {
+                deliver({name, quote, "", true}, &PriceBatchStats::cached);
+                ended = true;
+                continue;
+            }
+            lookup(name);
+        }
+    }
+
+    void lookup(const std::string& name) {
+        auto self   = shared_from_this();
+        bool leader = priceFlights.joinOrWait(name, [self, name](const PriceQuotePtr& quote) {
+            if (quote)
+                self->deliver({name, quote, "", false}, &PriceBatchStats::shared);
+            else
+                self->deliverFailure(name, "Steam request failed");
+            self->pump(true);
+        });
+        if (!leader) {
+            // Don't let a waiting caller sit behind a background fetch
+            if (priority == FetchPriority::Interactive) promoteFetch(priceOverviewURL(name));
+            return;
+        }
+
+        fetchAsync(priceOverviewURL(name), [self, name](const FetchResult& result) {
+            std::string   error;
+            PriceQuotePtr quote = parsePriceOverview(result, &error);
+            if (quote) {
+                priceCache().insert(name, quote);
+                priceHistory().record(intern(name), priceTextCents(quote->lowest), -1,
+                                      std::chrono::duration_cast<std::chrono::seconds>(
+                                          quote->fetchedAt.time_since_epoch()).count());
+            } else if (result.rejected) {
+                LOG_DEBUG("price") << error << " | " << name;
+            } else {
+                LOG_WARN("price") << error << " | " << name;
+            }
+            priceFlights.finish(name, quote);
+            if (quote)
+                self->deliver({name, quote, "", false}, &PriceBatchStats::fetched);
+            else
+                self->deliverFailure(name, error);
+            self->pump(true);
+        }, priority);
+    }
+
+    void finish() {
+        LOG_DEBUG("price") << stats.unique << " names | " << stats.cached << " cached, "
+                           << stats.fetched << " fetched, " << stats.shared << " shared, "
+                           << stats.stale << " stale, " << stats.failed << " failed";
+        done(stats);
+    }
+};
+
+} // namespace
+
+void fetchPrices(
+    const std::vector<std::string>&            names,
+    PriceSink                                  sink,
+    std::function<void(PriceBatchStats stats)> done,
+    FetchPriority                              priority
+) {
+    static const size_t window = static_cast<size_t>(std::max(1, envInt("SKIN_PRICE_BATCH_WINDOW", 16)));
+
+    auto batch      = std::make_shared<PriceBatch>();
+    batch->sink     = std::move(sink);
+    batch->done     = std::move(done);
+    batch->priority = priority;
+    batch->window   = window;
+
+    std::vector<std::string>        unique;
+    std::unordered_set<std::string> seen;
+    for (const auto& name : names)
+        if (!name.empty() && seen.insert(name).second)
+            unique.push_back(name);
+
+    batch->stats.unique = static_cast<int>(unique.size());
+    batch->remaining    = unique.size();
+    if (unique.empty()) {
+        batch->finish();
+        return;
+    }
+
+    std::deque<std::string> uncached;
+    for (auto& name : unique) {
+        if (PriceQuotePtr quote = priceCache().find(name))
+            batch->deliver({name, quote, "", true}, &PriceBatchStats::cached);
+        else
+            uncached.push_back(std::move(name));
+    }
+    if (uncached.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        batch->queue = std::move(uncached);
+    }
+    batch->pump(false);
+}
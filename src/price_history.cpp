@@ -0,0 +1,463 @@
+#include "price_history.h"
+#include "config.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+constexpr uint32_t HISTORY_MAGIC = 0x31484b53;   // "SKH1"
+
+struct HistoryBlockHeader {
+    uint32_t magic;
+    uint32_t names;
+    uint32_t records;
+    uint32_t payloadBytes;
+    uint64_t checksum;      // FNV-1a of the payload
+};
+
+uint64_t fnv1a(const char* data, size_t n) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < n; i++)
+        h = (h ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+    return h;
+}
+
+uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+void putVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+// Reads one varint from [*p, end). Returns false on a truncated value.
+bool getVarint(const char*& p, const char* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t b = static_cast<uint8_t>(*p++);
+        v |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// Cursor over one chunk's records, from its (firstT, 0, 0) baseline.
+struct ChunkReader {
+    const char* p;
+    const char* end;
+    int64_t     t;
+    int64_t     price    = 0;
+    int64_t     listings = 0;
+
+    bool next() {
+        uint64_t dt, dp, dl;
+        if (!getVarint(p, end, dt) || !getVarint(p, end, dp) || !getVarint(p, end, dl))
+            return false;
+        t        += unzigzag(dt);
+        price    += unzigzag(dp);
+        listings += unzigzag(dl);
+        return true;
+    }
+};
+
+// Encodes samples into the file's block format.
+class BlockWriter {
+public:
+    void add(std::string_view name, int64_t t, int price, int listings) {
+        auto [it, added] = names_.emplace(name, static_cast<uint32_t>(names_.size()));
+        if (added) {
+            putVarint(nameTable_, name.size());
+            nameTable_.append(name.data(), name.size());
+        }
+        putVarint(records_, it->second);
+        putVarint(records_, zigzag(t - prevT_));
+        putVarint(records_, zigzag(price));
+        putVarint(records_, zigzag(listings));
+        prevT_ = t;
+        count_++;
+    }
+
+    bool   empty() const { return count_ == 0; }
+    size_t size() const  { return count_; }
+
+    // Appends the finished block to `out` and starts a new one.
+    void finish(std::string& out) {
+        std::string payload = nameTable_ + records_;
+
+        HistoryBlockHeader h{};
+        h.magic        = HISTORY_MAGIC;
+        h.names        = static_cast<uint32_t>(names_.size());
+        h.records      = static_cast<uint32_t>(count_);
+        h.payloadBytes = static_cast<uint32_t>(payload.size());
+        h.checksum     = fnv1a(payload.data(), payload.size());
+
+        out.append(reinterpret_cast<const char*>(&h), sizeof(h));
+        out += payload;
+
+        names_.clear();
+        nameTable_.clear();
+        records_.clear();
+        prevT_ = 0;
+        count_ = 0;
+    }
+
+private:
+    std::unordered_map<std::string_view, uint32_t> names_;
+    std::string                                    nameTable_;
+    std::string                                    records_;
+    int64_t                                        prevT_ = 0;
+    size_t                                         count_ = 0;
+};
+
+// Blocks are capped so a torn write loses little and payloads fit in 32 bits.
+constexpr size_t BLOCK_RECORDS = 65536;
+
+// Files smaller than this are never compacted at runtime, however much of
+// them memory has dropped; rewriting them would save little.
+constexpr size_t MIN_COMPACT_SAMPLES = 100000;
+
+// One record is three varints of at most 10 bytes each.
+constexpr size_t MAX_RECORD_BYTES = 30;
+
+// First allocation of a chunk buffer; it doubles from there.
+constexpr size_t FIRST_CHUNK_BYTES = 32;
+
+// Heap bytes behind a string; short ones live inside the object.
+size_t heapBytes(const std::string& s) {
+    return s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0;
+}
+
+// Per item outside its chunks: the map node (key, Series, next pointer,
+// cached hash) and its bucket.
+template <typename Map>
+constexpr size_t seriesOverhead() {
+    return sizeof(typename Map::value_type) + 3 * sizeof(void*);
+}
+
+bool appendToFile(const std::string& path, const std::string& data) {
+    std::FILE* f = std::fopen(path.c_str(), "ab");
+    if (!f) {
+        LOG_WARN("history") << "Cannot open " << path;
+        return false;
+    }
+    bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok) LOG_WARN("history") << "Write failed: " << path;
+    return ok;
+}
+
+} // namespace
+
+PriceHistory::PriceHistory(HistoryConfig config) : config_(config) {
+    config_.chunksPerItem = std::max<size_t>(1, config_.chunksPerItem);
+}
+
+PriceHistory::Series& PriceHistory::seriesLocked(Shard& shard, StrId hashName) {
+    auto [it, added] = shard.series.try_emplace(hashName);
+    if (added)
+        bytes_ += seriesOverhead<decltype(shard.series)>();
+    return it->second;
+}
+
+bool PriceHistory::recordLocked(Series& s, int priceCents, int listings, int64_t t) {
+    if (listings < 0) listings = s.lastListings;
+
+    if (!s.chunks.empty()) {
+        if (t < s.lastT + config_.resolution.count()) return false;
+        if (priceCents == s.lastPrice && t < s.lastT + config_.heartbeat.count()) return false;
+    }
+
+    size_t slots = s.chunks.capacity();
+    bool   fresh = s.chunks.empty() || s.chunks.back().bytes.size() >= CHUNK_BYTES;
+    if (fresh) {
+        if (s.chunks.size() >= config_.chunksPerItem) {
+            bytes_   -= heapBytes(s.chunks.front().bytes);
+            samples_ -= s.chunks.front().samples;
+            s.chunks.erase(s.chunks.begin());
+        }
+        Chunk c;
+        c.firstT = t;
+        c.lastT  = t;
+        s.chunks.push_back(std::move(c));
+
+        // A new chunk restarts from its own baseline
+        s.lastPrice    = 0;
+        s.lastListings = 0;
+    }
+
+    Chunk& c      = s.chunks.back();
+    size_t before = heapBytes(c.bytes);
+    if (c.bytes.size() + MAX_RECORD_BYTES > c.bytes.capacity())
+        c.bytes.reserve(std::min(CHUNK_BYTES + MAX_RECORD_BYTES,
+                                 std::max(FIRST_CHUNK_BYTES, c.bytes.capacity() * 2)));
+
+    putVarint(c.bytes, fresh ? 0 : zigzag(t - s.lastT));
+    putVarint(c.bytes, zigzag(static_cast<int64_t>(priceCents) - s.lastPrice));
+    putVarint(c.bytes, zigzag(static_cast<int64_t>(listings) - s.lastListings));
+    c.lastT = t;
+    c.samples++;
+    bytes_ += heapBytes(c.bytes) - before + (s.chunks.capacity() - slots) * sizeof(Chunk);
+    samples_++;
+
+    s.lastT        = t;
+    s.lastPrice    = priceCents;
+    s.lastListings = listings;
+    return true;
+}
+
+void PriceHistory::record(StrId hashName, int priceCents, int listings, int64_t t) {
+    if (hashName == 0 || priceCents <= 0) return;
+
+    Shard& shard = shards_[hashName % SHARDS];
+    int    stored;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Series& s = seriesLocked(shard, hashName);
+        if (!recordLocked(s, priceCents, listings, t)) return;
+        stored = s.lastListings;
+    }
+
+    if (persisting_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        pending_.push_back({hashName, t, priceCents, stored});
+    }
+}
+
+void PriceHistory::recordPage(const std::vector<Skin>& page, int64_t t) {
+    for (const auto& skin : page)
+        record(skin.hash_name, skin.price_cents, skin.listings, t);
+}
+
+std::vector<HistoryPoint> PriceHistory::query(StrId hashName, int64_t from, int64_t to, int64_t step) const {
+    std::vector<HistoryPoint> points;
+    if (hashName == 0 || step <= 0 || to <= from) return points;
+
+    const Shard& shard = shards_[hashName % SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.series.find(hashName);
+    if (it == shard.series.end()) return points;
+
+    for (const Chunk& c : it->second.chunks) {
+        if (c.lastT < from) continue;
+        if (c.firstT >= to) break;
+
+        ChunkReader r{c.bytes.data(), c.bytes.data() + c.bytes.size(), c.firstT};
+        while (r.next()) {
+            if (r.t < from) continue;
+            if (r.t >= to) break;
+
+            int64_t bucket = from + (r.t - from) / step * step;
+            int     price  = static_cast<int>(r.price);
+            if (points.empty() || points.back().t != bucket) {
+                points.push_back({bucket, price, price, price, price, static_cast<int>(r.listings), 1});
+                continue;
+            }
+            HistoryPoint& p = points.back();
+            p.low      = std::min(p.low, price);
+            p.high     = std::max(p.high, price);
+            p.close    = price;
+            p.listings = static_cast<int>(r.listings);
+            p.samples++;
+        }
+    }
+    return points;
+}
+
+HistoryStats PriceHistory::stats() const {
+    size_t items = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        items += shard.series.size();
+    }
+    return {items, samples_.load(), bytes_.load()};
+}
+
+// ─── Persistence ───────────────────────────────────────────
+
+size_t PriceHistory::load(const std::string& path) {
+    persisting_ = true;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    size_t      read  = 0;
+    const char* p     = data.data();
+    const char* end   = data.data() + data.size();
+    const char* valid = p;
+
+    while (static_cast<size_t>(end - p) >= sizeof(HistoryBlockHeader)) {
+        HistoryBlockHeader h;
+        std::memcpy(&h, p, sizeof(h));
+        const char* payload = p + sizeof(h);
+        if (h.magic != HISTORY_MAGIC || h.payloadBytes > static_cast<size_t>(end - payload) ||
+            fnv1a(payload, h.payloadBytes) != h.checksum)
+            break;
+
+        const char*              q    = payload;
+        const char*              qEnd = payload + h.payloadBytes;
+        std::vector<StrId>       names;
+        bool                     ok   = true;
+        names.reserve(h.names);
+        for (uint32_t i = 0; i < h.names && ok; i++) {
+            uint64_t len;
+            ok = getVarint(q, qEnd, len) && len <= static_cast<uint64_t>(qEnd - q);
+            if (ok) {
+                names.push_back(intern(std::string_view(q, len)));
+                q += len;
+            }
+        }
+
+        int64_t t = 0;
+        for (uint32_t i = 0; i < h.records && ok; i++) {
+            uint64_t name, dt, price, listings;
+            ok = getVarint(q, qEnd, name) && getVarint(q, qEnd, dt) &&
+                 getVarint(q, qEnd, price) && getVarint(q, qEnd, listings) && name < names.size();
+            if (!ok) break;
+            t += unzigzag(dt);
+
+            Shard& shard = shards_[names[name] % SHARDS];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            recordLocked(seriesLocked(shard, names[name]), static_cast<int>(unzigzag(price)),
+                         static_cast<int>(unzigzag(listings)), t);
+            read++;
+        }
+        if (!ok) break;
+
+        p     = qEnd;
+        valid = p;
+    }
+
+    std::error_code ec;
+    if (valid != end) {
+        LOG_WARN("history") << "Dropping " << (end - valid) << " unreadable bytes at the end of " << path;
+        std::filesystem::resize_file(path, static_cast<uintmax_t>(valid - data.data()), ec);
+    }
+
+    HistoryStats st = stats();
+    LOG_INFO("history") << "Restored " << st.samples << " samples for " << st.items
+                        << " items from " << path;
+
+    fileSamples_ = read;
+    if (read > 2 * st.samples) compact(path);
+    return read;
+}
+
+bool PriceHistory::appendPending(const std::string& path) {
+    std::vector<Sample> batch;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        batch.swap(pending_);
+    }
+    if (batch.empty()) return true;
+
+    std::string out;
+    BlockWriter block;
+    for (const auto& s : batch) {
+        block.add(interned(s.name), s.t, s.price, s.listings);
+        if (block.size() >= BLOCK_RECORDS) block.finish(out);
+    }
+    if (!block.empty()) block.finish(out);
+    if (!appendToFile(path, out)) return false;
+
+    // Dropped chunks stay in the file until it is rewritten
+    fileSamples_ += batch.size();
+    if (fileSamples_ > MIN_COMPACT_SAMPLES && fileSamples_ > 2 * samples_.load())
+        compact(path);
+    return true;
+}
+
+bool PriceHistory::compact(const std::string& path) {
+    std::string out;
+    BlockWriter block;
+    size_t      written = 0;
+
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [name, series] : shard.series) {
+            for (const Chunk& c : series.chunks) {
+                ChunkReader r{c.bytes.data(), c.bytes.data() + c.bytes.size(), c.firstT};
+                while (r.next()) {
+                    block.add(interned(name), r.t, static_cast<int>(r.price), static_cast<int>(r.listings));
+                    if (block.size() >= BLOCK_RECORDS) block.finish(out);
+                    written++;
+                }
+            }
+        }
+    }
+    if (!block.empty()) block.finish(out);
+
+    std::string tmp = path + ".tmp";
+    std::remove(tmp.c_str());
+    if (!appendToFile(tmp, out)) return false;
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        LOG_WARN("history") << "Cannot replace " << path << ": " << ec.message();
+        return false;
+    }
+    fileSamples_ = written;
+    LOG_INFO("history") << "Compacted " << path << " to " << written << " samples";
+    return true;
+}
+
+PriceHistory& priceHistory() {
+    static PriceHistory history(HistoryConfig{
+        std::chrono::seconds(std::max(0, envInt("SKIN_HISTORY_RESOLUTION_SEC", 60))),
+        std::chrono::seconds(std::max(0, envInt("SKIN_HISTORY_HEARTBEAT_SEC", 21600))),
+        static_cast<size_t>(std::max(1, envInt("SKIN_HISTORY_CHUNKS", 64))),
+    });
+    return history;
+}
+
+// ─── Writer ────────────────────────────────────────────────
+
+HistoryWriter::HistoryWriter(PriceHistory& history, std::string path, std::chrono::seconds interval)
+    : history_(history), path_(std::move(path)), interval_(interval) {}
+
+HistoryWriter::~HistoryWriter() {
+    stop();
+}
+
+void HistoryWriter::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) return;
+    stopping_ = false;
+    thread_   = std::thread([this]() { run(); });
+}
+
+void HistoryWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!thread_.joinable()) return;
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+    history_.appendPending(path_);
+}
+
+void HistoryWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (wake_.wait_for(lock, interval_, [this]() { return stopping_; }))
+            break;
+        lock.unlock();
+        history_.appendPending(path_);
+        lock.lock();
+    }
+}
@@ -0,0 +1,90 @@
+#include "rate_limiter.h"
+#include "config.h"
+
+#include <algorithm>
+#include <cmath>
+
+TokenBucket::TokenBucket(std::chrono::milliseconds interval, int burst, std::chrono::milliseconds maxInterval)
+    : base_(static_cast<double>(std::max<long long>(interval.count(), 1))),
+      max_(std::max(base_, static_cast<double>(maxInterval.count()))),
+      burst_(std::max(burst, 1)),
+      interval_(base_),
+      tokens_(static_cast<double>(burst_)),
+      last_(Clock::now()),
+      pausedUntil_(last_),
+      lastBackoff_(last_ - std::chrono::hours(1)) {}
+
+void TokenBucket::refillLocked(Clock::time_point now) {
+    // Nothing accrues while paused by a Retry-After
+    Clock::time_point from = std::max(last_, pausedUntil_);
+    if (now > from) {
+        double elapsed = std::chrono::duration<double, std::milli>(now - from).count();
+        tokens_ = std::min(static_cast<double>(burst_), tokens_ + elapsed / interval_);
+    }
+    last_ = now;
+}
+
+bool TokenBucket::tryAcquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refillLocked(Clock::now());
+    if (tokens_ < 1.0) return false;
+    tokens_ -= 1.0;
+    return true;
+}
+
+std::chrono::milliseconds TokenBucket::timeUntilNext() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+    refillLocked(now);
+    if (tokens_ >= 1.0) return std::chrono::milliseconds(0);
+    double wait = (1.0 - tokens_) * interval_;
+    if (pausedUntil_ > now)
+        wait += std::chrono::duration<double, std::milli>(pausedUntil_ - now).count();
+    return std::chrono::milliseconds(static_cast<long long>(std::ceil(wait)));
+}
+
+double TokenBucket::available() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refillLocked(Clock::now());
+    return tokens_;
+}
+
+void TokenBucket::throttled(std::chrono::seconds retryAfter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+    refillLocked(now);
+
+    // Transfers sent in the same burst come back throttled together; that
+    // is one signal, not several
+    auto sinceBackoff = std::chrono::duration<double, std::milli>(now - lastBackoff_).count();
+    if (sinceBackoff >= interval_) {
+        interval_    = std::min(max_, interval_ * 2.0);
+        lastBackoff_ = now;
+    }
+    tokens_ = 0.0;
+    if (retryAfter.count() > 0)
+        pausedUntil_ = std::max(pausedUntil_, now + retryAfter);
+}
+
+void TokenBucket::succeeded() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (interval_ <= base_) return;
+
+    // Additive increase of the rate (1 / interval), in steps of base / 16
+    double rate = 1.0 / interval_ + 1.0 / (base_ * 16.0);
+    interval_   = std::max(base_, 1.0 / rate);
+}
+
+std::chrono::milliseconds TokenBucket::interval() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::chrono::milliseconds(static_cast<long long>(std::ceil(interval_)));
+}
+
+TokenBucket& steamLimiter() {
+    static TokenBucket bucket(
+        std::chrono::milliseconds(envInt("STEAM_RATE_LIMIT_MS", 150)),
+        envInt("STEAM_RATE_BURST", 10),
+        std::chrono::milliseconds(envInt("STEAM_RATE_MAX_MS", 10000))
+    );
+    return bucket;
+}
@@ -0,0 +1,151 @@
+#include "response_cache.h"
+#include "config.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// Bodies smaller than this go out uncompressed; gzip framing would eat
+// most of the saving.
+static constexpr size_t MIN_GZIP_BYTES = 256;
+
+ResponseCache::ResponseCache(size_t maxBytes) : maxBytes_(maxBytes) {}
+
+size_t ResponseCache::footprint(const Lru::value_type& e) {
+    const CachedBody& b = *e.second;
+    return e.first.size() + b.body.size() + b.gzip.size() + b.etag.size() + b.gzipEtag.size();
+}
+
+CachedBodyPtr ResponseCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        misses_++;
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    hits_++;
+    return it->second->second;
+}
+
+CachedBodyPtr ResponseCache::insert(const std::string& key, std::string body) {
+    // Compress outside the lock; concurrent misses on one key just race to
+    // store identical bodies
+    auto entry = std::make_shared<const CachedBody>(makeBody(std::move(body), Z_BEST_COMPRESSION));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        bytes_ -= footprint(*it->second);
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    lru_.emplace_front(key, entry);
+    index_[key] = lru_.begin();
+    bytes_ += footprint(lru_.front());
+
+    while (bytes_ > maxBytes_ && lru_.size() > 1) {
+        bytes_ -= footprint(lru_.back());
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+    return entry;
+}
+
+ResponseCacheStats ResponseCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {hits_.load(), misses_.load(), notModified_.load(), index_.size(), bytes_};
+}
+
+static std::string strongEtag(const std::string& body) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : body)
+        h = (h ^ c) * 0x100000001b3ULL;
+
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "\"%016llx\"", static_cast<unsigned long long>(h));
+    return buf;
+}
+
+CachedBody makeBody(std::string body, int level) {
+    CachedBody b;
+    b.etag = strongEtag(body);
+    if (body.size() >= MIN_GZIP_BYTES) {
+        std::string gz = gzipCompress(body, level);
+        if (!gz.empty() && gz.size() < body.size()) {
+            b.gzip     = std::move(gz);
+            b.gzipEtag = b.etag.substr(0, b.etag.size() - 1) + "-gz\"";
+        }
+    }
+    b.body = std::move(body);
+    return b;
+}
+
+std::string gzipCompress(const std::string& data, int level) {
+    z_stream zs{};
+    // windowBits 15 + 16 selects the gzip wrapper instead of raw zlib
+    if (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return "";
+
+    std::string out(deflateBound(&zs, static_cast<uLong>(data.size())), '\0');
+    zs.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    zs.avail_in  = static_cast<uInt>(data.size());
+    zs.next_out  = reinterpret_cast<Bytef*>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+
+    int rc = deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return rc == Z_STREAM_END ? out : "";
+}
+
+static std::string trim(const std::string& s) {
+    size_t a = s.find_first_not_of(" \t");
+    size_t b = s.find_last_not_of(" \t");
+    return a == std::string::npos ? "" : s.substr(a, b - a + 1);
+}
+
+// Calls `fn` with each trimmed element of a comma-separated header.
+template <typename F>
+static bool anyElement(const std::string& header, F fn) {
+    size_t pos = 0;
+    while (pos <= header.size()) {
+        size_t comma = header.find(',', pos);
+        if (comma == std::string::npos) comma = header.size();
+        if (fn(trim(header.substr(pos, comma - pos)))) return true;
+        pos = comma + 1;
+    }
+    return false;
+}
+
+bool acceptsGzip(const std::string& acceptEncoding) {
+    return anyElement(acceptEncoding, [](const std::string& item) {
+        size_t      semi = item.find(';');
+        std::string name = trim(item.substr(0, semi));
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (name != "gzip" && name != "*") return false;
+        if (semi == std::string::npos) return true;
+
+        std::string params = item.substr(semi + 1);
+        size_t      q      = params.find("q=");
+        return q == std::string::npos || std::atof(params.c_str() + q + 2) > 0.0;
+    });
+}
+
+bool etagMatches(const std::string& ifNoneMatch, const std::string& etag) {
+    return anyElement(ifNoneMatch, [&](const std::string& tag) {
+        if (tag == "*") return true;
+        return (tag.compare(0, 2, "W/") == 0 ? tag.substr(2) : tag) == etag;
+    });
+}
+
+ResponseCache& responseCache() {
+    static ResponseCache cache(static_cast<size_t>(std::max(1, envInt("SKIN_RESPONSE_CACHE_MB", 32))) << 20);
+    return cache;
+}
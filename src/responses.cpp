@@ -0,0 +1,135 @@
+#include "responses.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+crow::json::wvalue skinToJson(const Skin& s) {
+    crow::json::wvalue j;
+    j["name"]            = std::string(interned(s.name));
+    j["hash_name"]       = std::string(interned(s.hash_name));
+    j["sell_price"]      = s.price_cents;
+    j["sell_price_text"] = std::string(interned(s.price_text));
+    j["sale_price_text"] = std::string(interned(s.sale_price_text));
+    j["sell_listings"]   = s.listings;
+    j["icon_url"]        = iconURL(s);
+    j["market_url"]      = marketURL(s);
+    j["weapon"]          = std::string(interned(s.weapon));
+    j["finish"]          = std::string(interned(s.finish));
+    j["wear"]            = wearKey(s.wear);
+    j["category"]        = categoryName(s.category);
+    j["stattrak"]        = (s.flags & SKIN_STATTRAK) != 0;
+    j["souvenir"]        = (s.flags & SKIN_SOUVENIR) != 0;
+    return j;
+}
+
+crow::json::wvalue skinToOptionJson(const Skin& s) {
+    crow::json::wvalue o;
+    o["name"]        = std::string(interned(s.name));
+    o["price"]       = std::string(interned(s.price_text));
+    o["price_cents"] = s.price_cents;
+    o["listings"]    = s.listings;
+    o["icon_url"]    = iconURL(s);
+    o["market_url"]  = marketURL(s);
+    return o;
+}
+
+crow::json::wvalue priceToJson(const PriceResult& r) {
+    crow::json::wvalue j;
+    j["name"] = r.name;
+    if (!r.quote) {
+        j["error"] = r.error;
+        return j;
+    }
+
+    auto fetchedAt = r.quote->fetchedAt;
+    j["lowest_price"] = r.quote->lowest;
+    j["median_price"] = r.quote->median;
+    j["volume"]       = r.quote->volume;
+    j["fetched_at"]   = static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(
+        fetchedAt.time_since_epoch()).count());
+    j["age_seconds"]  = std::chrono::duration<double>(std::chrono::system_clock::now() - fetchedAt).count();
+    j["cached"]       = r.cached;
+    if (r.stale)
+        j["stale"] = true;
+    return j;
+}
+
+std::string skinsFingerprint(const std::vector<Skin>& skins) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    auto mix = [&](uint64_t v) { h = (h ^ v) * 0x100000001b3ULL; };
+    for (const auto& s : skins) {
+        mix(s.name);
+        mix(s.hash_name);
+        mix(s.price_text);
+        mix(s.sale_price_text);
+        mix(s.icon);
+        mix(static_cast<uint32_t>(s.price_cents));
+        mix(static_cast<uint32_t>(s.listings));
+    }
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+    return buf;
+}
+
+crow::response sendBody(const crow::request& req, const CachedBody& b, bool revalidate) {
+    bool useGzip = !b.gzip.empty() && acceptsGzip(req.get_header_value("Accept-Encoding"));
+    const std::string& etag = useGzip ? b.gzipEtag : b.etag;
+
+    crow::response res;
+    res.set_header("ETag", etag);
+    res.set_header("Vary", "Accept-Encoding");
+    res.set_header("Cache-Control", "no-cache");
+
+    if (revalidate && etagMatches(req.get_header_value("If-None-Match"), etag)) {
+        responseCache().countNotModified();
+        res.code = 304;
+        return res;
+    }
+
+    res.set_header("Content-Type", "application/json");
+    if (useGzip) {
+        res.set_header("Content-Encoding", "gzip");
+        res.body = b.gzip;
+    } else {
+        res.body = b.body;
+    }
+    return res;
+}
+
+crow::response sendCached(
+    const crow::request&                       req,
+    const std::string&                         key,
+    const std::function<crow::json::wvalue()>& build
+) {
+    CachedBodyPtr entry = responseCache().find(key);
+    if (!entry)
+        entry = responseCache().insert(key, build().dump());
+    return sendBody(req, *entry, req.method == crow::HTTPMethod::Get);
+}
+
+void markStale(crow::json::wvalue& r, const PageFreshness& pages) {
+    if (!pages.degraded()) return;
+    r["stale"]         = true;
+    r["missing_pages"] = static_cast<int>(pages.missing);
+    if (pages.stale > 0)
+        r["age_seconds"] = pages.ageSeconds;
+}
+
+crow::response sendPages(
+    const crow::request&                       req,
+    const std::string&                         key,
+    const PageFreshness&                       pages,
+    const std::function<crow::json::wvalue()>& build
+) {
+    if (!pages.degraded())
+        return sendCached(req, key, build);
+
+    crow::json::wvalue r = build();
+    markStale(r, pages);
+    return sendJson(req, r);
+}
+
+crow::response sendJson(const crow::request& req, crow::json::wvalue& value) {
+    return sendBody(req, makeBody(value.dump(), 6), false);
+}
@@ -0,0 +1,339 @@
+#include "search_index.h"
+#include "config.h"
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+
+// Shorter final words match exactly; a one- or two-letter prefix would
+// union most of the vocabulary.
+static constexpr size_t MIN_PREFIX_LENGTH = 3;
+
+// Packed doc attributes: bits 0-31 hold the interned id of the lowercased
+// weapon, bits 32-39 the wear as a one-hot bit, bit 40 StatTrak.
+static constexpr int      WEAR_SHIFT   = 32;
+static constexpr uint64_t WEAPON_MASK  = 0xFFFFFFFFull;
+static constexpr uint64_t STATTRAK_BIT = uint64_t(1) << 40;
+
+static std::string lowercase(std::string_view s) {
+    std::string out(s);
+    for (char& c : out)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+static uint64_t packAttributes(const Skin& s) {
+    return intern(lowercase(interned(s.weapon))) |
+           uint64_t(1) << (WEAR_SHIFT + static_cast<int>(s.wear)) |
+           ((s.flags & SKIN_STATTRAK) ? STATTRAK_BIT : 0);
+}
+
+namespace {
+
+// A SearchFilter's attribute tests as one mask-and-compare, plus the set
+// of wear bits of which at least one must be present.
+struct PackedFilter {
+    uint64_t mask     = 0;
+    uint64_t want     = 0;
+    uint64_t anyWear  = 0;
+    bool     possible = true;
+
+    explicit PackedFilter(const SearchFilter& f) {
+        if (!f.weapon.empty()) {
+            // Never interned means no skin has this weapon
+            StrId id = findInterned(lowercase(f.weapon));
+            possible = id != 0;
+            mask    |= WEAPON_MASK;
+            want    |= id;
+        }
+        if (f.stattrak >= 0) {
+            mask |= STATTRAK_BIT;
+            if (f.stattrak) want |= STATTRAK_BIT;
+        }
+        anyWear = uint64_t(f.wears & 0xFF) << WEAR_SHIFT;
+    }
+
+    bool matches(uint64_t attrs) const {
+        return (attrs & mask) == want && (!anyWear || (attrs & anyWear));
+    }
+};
+
+} // namespace
+
+uint32_t parseWearList(std::string_view list, std::string* error) {
+    uint32_t wears = 0;
+    while (!list.empty()) {
+        size_t           comma = list.find(',');
+        std::string_view item  = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+        if (item.empty()) continue;
+
+        Wear w = parseWear(item);
+        if (w == Wear::None) {
+            *error = "Unknown wear '" + std::string(item) + "'";
+            return 0;
+        }
+        wears |= 1u << static_cast<int>(w);
+    }
+    return wears;
+}
+
+bool SearchFilter::matches(const Skin& s) const {
+    if (s.price_cents < min_cents || s.price_cents > max_cents) return false;
+    if (wears && !(wears & (1u << static_cast<int>(s.wear)))) return false;
+    if (stattrak >= 0 && ((s.flags & SKIN_STATTRAK) != 0) != (stattrak == 1)) return false;
+    return weapon.empty() || lowercase(interned(s.weapon)) == lowercase(weapon);
+}
+
+SearchIndex::SearchIndex(std::chrono::seconds maxAge) : maxAge_(maxAge), lastPrune_(Clock::now()) {}
+
+// ASCII letters and digits only: "StatTrak™" -> stattrak, "★ Karambit" ->
+// karambit. Duplicates are removed.
+std::vector<std::string> SearchIndex::tokenize(const std::string& text) {
+    std::vector<std::string> tokens;
+    std::string cur;
+    for (char c : text) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (u < 0x80 && std::isalnum(u)) {
+            cur += static_cast<char>(std::tolower(u));
+        } else if (!cur.empty()) {
+            tokens.push_back(std::move(cur));
+            cur.clear();
+        }
+    }
+    if (!cur.empty()) tokens.push_back(std::move(cur));
+
+    std::vector<std::string> unique;
+    for (auto& t : tokens)
+        if (std::find(unique.begin(), unique.end(), t) == unique.end())
+            unique.push_back(std::move(t));
+    return unique;
+}
+
+void SearchIndex::add(const std::vector<Skin>& page, const std::string& query) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto now = Clock::now();
+    addPageLocked(page, query, now);
+    flushLocked();
+    pruneLocked(now);
+}
+
+void SearchIndex::add(const std::vector<CachedPage>& pages) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto now = Clock::now();
+    for (const auto& cp : pages)
+        if (cp.page) addPageLocked(*cp.page, cp.key.query, now);
+    flushLocked();
+    pruneLocked(now);
+}
+
+void SearchIndex::add(const std::vector<SkinPage>& pages, const std::string& query) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto now = Clock::now();
+    for (const auto& page : pages)
+        if (page) addPageLocked(*page, query, now);
+    flushLocked();
+    pruneLocked(now);
+}
+
+void SearchIndex::addPageLocked(const std::vector<Skin>& page, const std::string& query,
+                                Clock::time_point now) {
+    std::vector<std::string> queryTokens = tokenize(query);
+    for (const auto& s : page)
+        addLocked(s, queryTokens, now);
+}
+
+// New postings are appended unsorted; each list's tail is folded back in
+// once per batch instead of shifting the list for every skin.
+void SearchIndex::flushLocked() {
+    for (const auto& [list, sortedLen] : pending_) {
+        auto mid = list->begin() + sortedLen;
+        std::sort(mid, list->end());
+        std::inplace_merge(list->begin(), mid, list->end());
+    }
+    pending_.clear();
+}
+
+// Compacts away docs past the max age, at most four times per max age.
+// Surviving docs keep their relative order, so renumbering them keeps
+// every posting list sorted.
+void SearchIndex::pruneLocked(Clock::time_point now) {
+    if (now - lastPrune_ < std::max<Clock::duration>(maxAge_ / 4, std::chrono::seconds(1))) return;
+    lastPrune_ = now;
+
+    auto cutoff = now - maxAge_;
+    std::vector<uint32_t> remap(docs_.size(), UINT32_MAX);
+    uint32_t kept = 0;
+    for (uint32_t id = 0; id < docs_.size(); id++) {
+        if (docs_[id].updatedAt < cutoff) {
+            byHash_.erase(docs_[id].skin.hash_name);
+            continue;
+        }
+        if (kept != id) {
+            docs_[kept]  = std::move(docs_[id]);
+            attrs_[kept] = attrs_[id];
+            byHash_[docs_[kept].skin.hash_name] = kept;
+        }
+        remap[id] = kept++;
+    }
+    if (kept == docs_.size()) return;
+    docs_.resize(kept);
+    attrs_.resize(kept);
+
+    postings_ = 0;
+    for (auto it = terms_.begin(); it != terms_.end();) {
+        Postings& list = it->second;
+        auto last = std::remove_if(list.begin(), list.end(),
+                                   [&](const Posting& p) { return remap[p.doc] == UINT32_MAX; });
+        list.erase(last, list.end());
+        for (auto& p : list)
+            p.doc = remap[p.doc];
+
+        if (list.empty()) {
+            it = terms_.erase(it);
+        } else {
+            list.shrink_to_fit();
+            postings_ += list.size();
+            ++it;
+        }
+    }
+}
+
+void SearchIndex::insertLocked(const std::string& token, Posting p) {
+    Postings& list = terms_[token];
+    pending_.emplace(&list, list.size());
+    list.push_back(p);
+    postings_++;
+}
+
+void SearchIndex::addLocked(const Skin& s, const std::vector<std::string>& queryTokens,
+                            Clock::time_point now) {
+    auto it = byHash_.find(s.hash_name);
+    if (it == byHash_.end()) {
+        uint32_t id = static_cast<uint32_t>(docs_.size());
+        byHash_.emplace(s.hash_name, id);
+        std::string text = std::string(interned(s.name)) + ' ' + std::string(interned(s.hash_name));
+        docs_.push_back({s, tokenize(text), now});
+        attrs_.push_back(packAttributes(s));
+        for (const auto& t : docs_.back().tokens)
+            insertLocked(t, {s.price_cents, id});
+    } else {
+        uint32_t id  = it->second;
+        Doc&     doc = docs_[id];
+
+        // Re-slot the postings only when the price moved
+        if (doc.skin.price_cents != s.price_cents) {
+            Posting oldP{doc.skin.price_cents, id};
+            for (const auto& t : doc.tokens) {
+                Postings& list = terms_[t];
+                removeLocked(list, oldP);
+                insertLocked(t, {s.price_cents, id});
+            }
+        }
+
+        doc.skin      = s;
+        doc.updatedAt = now;
+    }
+
+    // Steam also matches on item type ("Knife" finds "★ Karambit"), so a
+    // skin is findable by every query it has been returned for
+    uint32_t id  = byHash_[s.hash_name];
+    Doc&     doc = docs_[id];
+    for (const auto& t : queryTokens) {
+        if (std::find(doc.tokens.begin(), doc.tokens.end(), t) != doc.tokens.end()) continue;
+        doc.tokens.push_back(t);
+        insertLocked(t, {s.price_cents, id});
+    }
+}
+
+// Drops `p` from `list`, which may have an unsorted tail from this page.
+void SearchIndex::removeLocked(Postings& list, Posting p) {
+    auto   pend   = pending_.find(&list);
+    size_t sorted = pend != pending_.end() ? pend->second : list.size();
+
+    auto at = std::lower_bound(list.begin(), list.begin() + sorted, p);
+    if (at != list.begin() + sorted && *at == p) {
+        if (pend != pending_.end()) pend->second--;
+    } else {
+        at = std::find(list.begin() + sorted, list.end(), p);
+        if (at == list.end()) return;
+    }
+    list.erase(at);
+    postings_--;
+}
+
+// Appends the postings for `token` (or every term it prefixes) that fall in
+// the price window, as one list sorted by (price, doc).
+void SearchIndex::matchLocked(const std::string& token, bool prefix, int min_cents, int max_cents,
+                              Postings& out) const {
+    auto window = [&](const Postings& list) {
+        auto lo = std::lower_bound(list.begin(), list.end(), Posting{min_cents, 0});
+        auto hi = std::upper_bound(lo, list.end(), Posting{max_cents, UINT32_MAX});
+        out.insert(out.end(), lo, hi);
+    };
+
+    if (!prefix) {
+        auto it = terms_.find(token);
+        if (it != terms_.end()) window(it->second);
+        return;
+    }
+
+    size_t lists = 0;
+    for (auto it = terms_.lower_bound(token);
+         it != terms_.end() && it->first.compare(0, token.size(), token) == 0; ++it) {
+        window(it->second);
+        lists++;
+    }
+
+    // A doc can carry several terms with the same prefix ("st" -> stattrak, sticker)
+    if (lists > 1) {
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+}
+
+std::vector<Skin> SearchIndex::search(const std::string& query, const SearchFilter& filter) const {
+    std::vector<std::string> words = tokenize(query);
+    PackedFilter             attrs(filter);
+    if (words.empty() || filter.min_cents > filter.max_cents || !attrs.possible) return {};
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    std::vector<Postings> lists(words.size());
+    for (size_t i = 0; i < words.size(); i++) {
+        bool prefix = i + 1 == words.size() && words[i].size() >= MIN_PREFIX_LENGTH;
+        matchLocked(words[i], prefix, filter.min_cents, filter.max_cents, lists[i]);
+        if (lists[i].empty()) return {};
+    }
+
+    // Walk the shortest list and probe the rest; all are sorted the same way
+    std::sort(lists.begin(), lists.end(),
+              [](const Postings& a, const Postings& b) { return a.size() < b.size(); });
+
+    auto cutoff = Clock::now() - maxAge_;
+
+    std::vector<Skin> out;
+    for (auto p = lists[0].rbegin(); p != lists[0].rend(); ++p) {
+        if (!attrs.matches(attrs_[p->doc])) continue;
+
+        bool inAll = true;
+        for (size_t i = 1; i < lists.size() && inAll; i++)
+            inAll = std::binary_search(lists[i].begin(), lists[i].end(), *p);
+        if (!inAll) continue;
+
+        const Doc& doc = docs_[p->doc];
+        if (doc.updatedAt < cutoff) continue;
+        out.push_back(doc.skin);
+    }
+    return out;
+}
+
+SearchIndexStats SearchIndex::stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return {docs_.size(), terms_.size(), postings_};
+}
+
+SearchIndex& searchIndex() {
+    static SearchIndex index(std::chrono::seconds(envInt("SKIN_INDEX_MAX_AGE_SEC", 3600)));
+    return index;
+}
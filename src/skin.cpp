@@ -0,0 +1,214 @@
+#include "skin.h"
+#include "http_client.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Append-only pool. Ids index fixed-size blocks of views that never move,
+// so interned() reads without taking the lock; an id only reaches another
+// thread through a page published under the cache's (or a future's) lock.
+class StringPool {
+public:
+    StringPool() {
+        blocks_[0].store(new std::string_view[BLOCK_SIZE], std::memory_order_release);
+        count_ = 1;   // id 0 = ""
+    }
+
+    StrId intern(std::string_view s) {
+        if (s.empty()) return 0;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = ids_.find(s);
+        if (it != ids_.end()) return it->second;
+
+        size_t block = count_ / BLOCK_SIZE;
+        if (block >= MAX_BLOCKS) return 0;   // 268M distinct strings; not reachable in practice
+        if (!blocks_[block].load(std::memory_order_relaxed))
+            blocks_[block].store(new std::string_view[BLOCK_SIZE], std::memory_order_release);
+
+        std::string_view stored = copyLocked(s);
+        StrId            id     = static_cast<StrId>(count_++);
+        blocks_[block].load(std::memory_order_relaxed)[id % BLOCK_SIZE] = stored;
+        ids_.emplace(stored, id);
+        bytes_ += s.size();
+        return id;
+    }
+
+    StrId find(std::string_view s) {
+        if (s.empty()) return 0;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = ids_.find(s);
+        return it != ids_.end() ? it->second : 0;
+    }
+
+    std::string_view get(StrId id) const {
+        const std::string_view* block = blocks_[id / BLOCK_SIZE].load(std::memory_order_acquire);
+        return block ? block[id % BLOCK_SIZE] : std::string_view();
+    }
+
+    InternStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {count_ - 1, bytes_};
+    }
+
+private:
+    static constexpr size_t BLOCK_SIZE  = 1 << 16;
+    static constexpr size_t MAX_BLOCKS  = 1 << 12;
+    static constexpr size_t CHUNK_BYTES = 1 << 20;
+
+    // Packs string bytes into 1 MB chunks instead of one allocation each.
+    std::string_view copyLocked(std::string_view s) {
+        if (s.size() > CHUNK_BYTES / 4) {
+            large_.emplace_back(new char[s.size()]);
+            std::copy(s.begin(), s.end(), large_.back().get());
+            return std::string_view(large_.back().get(), s.size());
+        }
+        if (chunks_.empty() || chunkUsed_ + s.size() > CHUNK_BYTES) {
+            chunks_.emplace_back(new char[CHUNK_BYTES]);
+            chunkUsed_ = 0;
+        }
+        char* dst = chunks_.back().get() + chunkUsed_;
+        std::copy(s.begin(), s.end(), dst);
+        chunkUsed_ += s.size();
+        return std::string_view(dst, s.size());
+    }
+
+    std::mutex                                   mutex_;
+    std::unordered_map<std::string_view, StrId>  ids_;
+    std::atomic<std::string_view*>               blocks_[MAX_BLOCKS] = {};
+    std::vector<std::unique_ptr<char[]>>         chunks_;
+    std::vector<std::unique_ptr<char[]>>         large_;
+    size_t                                       chunkUsed_ = 0;
+    size_t                                       count_     = 0;
+    size_t                                       bytes_     = 0;
+};
+
+// Never destroyed: executor workers may still be finishing requests that
+// read skins while static destructors run at exit.
+static StringPool& stringPool() {
+    static StringPool* pool = new StringPool();
+    return *pool;
+}
+
+StrId intern(std::string_view s) {
+    return stringPool().intern(s);
+}
+
+std::string_view interned(StrId id) {
+    return stringPool().get(id);
+}
+
+StrId findInterned(std::string_view s) {
+    return stringPool().find(s);
+}
+
+InternStats internStats() {
+    return stringPool().stats();
+}
+
+std::string iconURL(const Skin& s) {
+    return ICON_URL_PREFIX + std::string(interned(s.icon));
+}
+
+std::string marketURL(const Skin& s) {
+    return MARKET_URL_PREFIX + urlEncode(std::string(interned(s.hash_name)));
+}
+
+// ─── Item Attributes ───────────────────────────────────────
+
+namespace {
+
+struct WearName {
+    Wear        wear;
+    const char* key;
+    const char* name;
+};
+
+constexpr WearName WEARS[] = {
+    {Wear::FactoryNew,    "fn", "Factory New"},
+    {Wear::MinimalWear,   "mw", "Minimal Wear"},
+    {Wear::FieldTested,   "ft", "Field-Tested"},
+    {Wear::WellWorn,      "ww", "Well-Worn"},
+    {Wear::BattleScarred, "bs", "Battle-Scarred"},
+};
+
+bool consumePrefix(std::string_view& s, std::string_view prefix) {
+    if (s.substr(0, prefix.size()) != prefix) return false;
+    s.remove_prefix(prefix.size());
+    return true;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) ==
+                      std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+} // namespace
+
+void parseItemAttributes(Skin& s) {
+    std::string_view rest = interned(s.hash_name);
+    if (rest.empty()) rest = interned(s.name);
+
+    // UTF-8 "★ " and "™ ", spelled out so the source charset does not matter
+    bool star = consumePrefix(rest, "\xE2\x98\x85 ");
+    s.flags   = 0;
+    if (consumePrefix(rest, "StatTrak\xE2\x84\xA2 ")) s.flags |= SKIN_STATTRAK;
+    if (consumePrefix(rest, "Souvenir ")) s.flags |= SKIN_SOUVENIR;
+
+    // A trailing "(Field-Tested)" is the wear; other parentheses are part
+    // of the name ("Sticker | Team (Holo)")
+    s.wear = Wear::None;
+    size_t open = rest.rfind(" (");
+    if (open != std::string_view::npos && !rest.empty() && rest.back() == ')') {
+        std::string_view inner = rest.substr(open + 2, rest.size() - open - 3);
+        for (const auto& w : WEARS) {
+            if (inner == w.name) {
+                s.wear = w.wear;
+                rest   = rest.substr(0, open);
+                break;
+            }
+        }
+    }
+
+    size_t bar = rest.find(" | ");
+    s.weapon   = intern(rest.substr(0, bar));
+    s.finish   = bar == std::string_view::npos ? 0 : intern(rest.substr(bar + 3));
+
+    std::string_view weapon = interned(s.weapon);
+    if (star)
+        s.category = weapon.find("Gloves") != std::string_view::npos ||
+                     weapon.find("Hand Wraps") != std::string_view::npos
+                   ? ItemCategory::Gloves : ItemCategory::Knife;
+    else
+        s.category = s.wear != Wear::None ? ItemCategory::Weapon : ItemCategory::Other;
+}
+
+const char* wearKey(Wear w) {
+    for (const auto& n : WEARS)
+        if (n.wear == w) return n.key;
+    return "";
+}
+
+Wear parseWear(std::string_view text) {
+    for (const auto& n : WEARS)
+        if (equalsIgnoreCase(text, n.key) || equalsIgnoreCase(text, n.name)) return n.wear;
+    return Wear::None;
+}
+
+const char* categoryName(ItemCategory c) {
+    switch (c) {
+    case ItemCategory::Weapon: return "weapon";
+    case ItemCategory::Knife:  return "knife";
+    case ItemCategory::Gloves: return "gloves";
+    case ItemCategory::Other:  return "other";
+    }
+    return "other";
+}
@@ -0,0 +1,253 @@
+#include "slot_fetch.h"
+#include "config.h"
+#include "loadout.h"
+#include "log.h"
+#include "metrics.h"
+#include "market_fetch.h"
+#include "responses.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <unordered_set>
+
+void sideQueries(
+    const std::string&        side,
+    std::vector<std::string>& primary,
+    std::vector<std::string>& secondary
+) {
+    if (side == "CT") {
+        primary   = {"M4A4", "M4A1-S", "AUG", "FAMAS"};
+        secondary = {"USP-S", "P2000", "Five-SeveN", "P250"};
+    } else {
+        primary   = {"AK-47", "SG 553", "Galil AR"};
+        secondary = {"Glock-18", "Tec-9", "Desert Eagle"};
+    }
+}
+
+void fetchSlots(
+    const std::vector<SlotRequest>&                   slots,
+    std::function<void(std::vector<SlotFetch> slots)> done
+) {
+    // Shared by every weapon query; the last one to finish hands it over
+    struct Pending {
+        std::vector<SlotFetch>                            fetches;
+        std::function<void(std::vector<SlotFetch> slots)> done;
+        std::atomic<size_t>                               remaining{0};
+    };
+
+    auto pending  = std::make_shared<Pending>();
+    pending->done = std::move(done);
+
+    size_t total = 0;
+    auto   now   = SlotFetch::Clock::now();
+    for (const auto& slot : slots) {
+        SlotFetch f;
+        f.started = now;
+        f.weapons.resize(slot.queries.size());
+        pending->fetches.push_back(std::move(f));
+        total += slot.queries.size();
+    }
+
+    pending->remaining = total;
+    if (total == 0) {
+        pending->done(std::move(pending->fetches));
+        return;
+    }
+
+    for (size_t s = 0; s < slots.size(); s++) {
+        for (size_t w = 0; w < slots[s].queries.size(); w++) {
+            fetchQuery(slots[s].queries[w], 3, 1, slots[s].budget_cents,
+                       [pending, s, w](std::vector<Skin> skins, const PageFreshness& pages) {
+                std::sort(skins.begin(), skins.end(), [](const Skin& a, const Skin& b) {
+                    return a.price_cents > b.price_cents;
+                });
+                SlotFetch::Weapon& weapon = pending->fetches[s].weapons[w];
+                weapon.skins    = std::move(skins);
+                weapon.pages    = pages;
+                weapon.finished = SlotFetch::Clock::now();
+
+                if (pending->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    pending->done(std::move(pending->fetches));
+            });
+        }
+    }
+}
+
+std::vector<std::vector<Skin>> finishSlotFetch(const SlotFetch& slot, double* elapsed_ms) {
+    std::vector<std::vector<Skin>> perWeapon;
+    std::unordered_set<StrId> globalSeen;
+    auto lastDone = slot.started;
+
+    for (const auto& w : slot.weapons) {
+        lastDone = std::max(lastDone, w.finished);
+
+        std::vector<Skin> filtered;
+        for (const auto& s : w.skins) {
+            if (globalSeen.insert(s.hash_name).second)
+                filtered.push_back(s);
+        }
+
+        if (!filtered.empty())
+            perWeapon.push_back(std::move(filtered));
+    }
+
+    if (elapsed_ms)
+        *elapsed_ms = std::chrono::duration<double, std::milli>(lastDone - slot.started).count();
+    return perWeapon;
+}
+
+PageFreshness slotFreshness(const std::vector<SlotFetch>& slots) {
+    PageFreshness merged;
+    for (const auto& slot : slots)
+        for (const auto& w : slot.weapons)
+            merged.merge(w.pages);
+    return merged;
+}
+
+std::vector<crow::json::wvalue> interleaveOptions(
+    const std::vector<std::vector<Skin>>& perWeapon,
+    int                                   max_options
+) {
+    // Interleave: pick best from each weapon round-robin, then second-best, etc.
+    std::vector<const Skin*> interleaved;
+    size_t maxDepth = 0;
+    for (auto& w : perWeapon)
+        if (w.size() > maxDepth) maxDepth = w.size();
+
+    for (size_t depth = 0; depth < maxDepth && static_cast<int>(interleaved.size()) < max_options; depth++) {
+        for (auto& w : perWeapon) {
+            if (static_cast<int>(interleaved.size()) >= max_options) break;
+            if (depth < w.size())
+                interleaved.push_back(&w[depth]);
+        }
+    }
+
+    std::vector<crow::json::wvalue> options;
+    for (const Skin* s : interleaved)
+        options.push_back(skinToOptionJson(*s));
+
+    LOG_DEBUG("interleaveOptions") << "Returning " << options.size()
+                                   << " options across " << perWeapon.size() << " weapons";
+
+    return options;
+}
+
+std::vector<SlotRequest> jointSlots(
+    const std::string&        side,
+    int                       total_cents,
+    bool                      include_knife,
+    bool                      include_gloves,
+    std::vector<std::string>& slotNames
+) {
+    std::vector<std::string> primary_queries, secondary_queries;
+    sideQueries(side, primary_queries, secondary_queries);
+
+    // Candidate pool per slot: every weapon's skins that fit the whole budget
+    slotNames = {"primary", "secondary"};
+    std::vector<SlotRequest> slots = {
+        {primary_queries,   total_cents},
+        {secondary_queries, total_cents},
+    };
+    if (include_knife) {
+        slotNames.push_back("knife");
+        slots.push_back({{"Knife"}, total_cents});
+    }
+    if (include_gloves) {
+        slotNames.push_back("gloves");
+        slots.push_back({{"Gloves"}, total_cents});
+    }
+    return slots;
+}
+
+crow::json::wvalue buildJointLoadouts(
+    const std::string&              side,
+    double                          total_budget,
+    int                             top_k,
+    const std::vector<std::string>& slotNames,
+    const std::vector<SlotFetch>&   fetches
+) {
+    int total_cents = static_cast<int>(std::lround(total_budget * 100));
+
+    // Per-slot fetch timing, as split mode reports it
+    std::vector<std::vector<Skin>>          pools(slotNames.size());
+    std::vector<std::vector<SlotCandidate>> candidates(slotNames.size());
+    crow::json::wvalue                      timing;
+    for (size_t s = 0; s < slotNames.size(); s++) {
+        double ms = 0.0;
+        for (auto& weapon : finishSlotFetch(fetches[s], &ms))
+            pools[s].insert(pools[s].end(), weapon.begin(), weapon.end());
+        for (const auto& skin : pools[s])
+            candidates[s].push_back({skin.price_cents, skin.price_cents});
+        timing[slotNames[s]] = ms;
+    }
+    timing["total"] = std::chrono::duration<double, std::milli>(
+        SlotFetch::Clock::now() - fetches.front().started).count();
+
+    auto started = std::chrono::steady_clock::now();
+    LoadoutStats stats;
+    std::vector<LoadoutPick> picks = optimizeLoadouts(candidates, total_cents, top_k, &stats);
+    double solve_ms = secondsSince(started) * 1000.0;
+
+    static Histogram& solveLatency = metrics().histogram(
+        "cs_skin_optimizer_solve_duration_seconds", "Optimizer solve time",
+        "algorithm=\"joint_loadout\"");
+    solveLatency.observe(solve_ms / 1000.0);
+
+    std::vector<crow::json::wvalue> loadouts;
+    for (const auto& pick : picks) {
+        crow::json::wvalue items;
+        for (size_t s = 0; s < slotNames.size(); s++)
+            items[slotNames[s]] = skinToOptionJson(pools[s][pick.choice[s]]);
+
+        crow::json::wvalue l;
+        l["total_cents"] = pick.price;
+        l["total_spent"] = pick.price / 100.0;
+        l["remaining"]   = total_budget - pick.price / 100.0;
+        l["items"]       = std::move(items);
+        loadouts.push_back(std::move(l));
+    }
+
+    LOG_DEBUG("loadout/build") << "joint: " << loadouts.size() << " loadouts from "
+                               << stats.kept << "/" << stats.candidates << " candidates in "
+                               << solve_ms << "ms";
+
+    crow::json::wvalue optimizer;
+    optimizer["candidates"] = static_cast<long long>(stats.candidates);
+    optimizer["kept"]       = static_cast<long long>(stats.kept);
+    optimizer["combos"]     = static_cast<long long>(stats.combos);
+    optimizer["solve_ms"]   = solve_ms;
+
+    crow::json::wvalue r;
+    r["side"]         = side;
+    r["mode"]         = "total";
+    r["total_budget"] = total_budget;
+    r["loadouts"]     = std::move(loadouts);
+    r["optimizer"]    = std::move(optimizer);
+    r["timing_ms"]    = std::move(timing);
+    return r;
+}
+
+void pinWarmSet(CatalogWarmer& warmer) {
+    for (const char* side : {"T", "CT"}) {
+        std::vector<std::string> primary, secondary;
+        sideQueries(side, primary, secondary);
+        for (const auto& q : primary)   warmer.pin(q, 3);
+        for (const auto& q : secondary) warmer.pin(q, 3);
+    }
+    warmer.pin("Knife",  3);
+    warmer.pin("Gloves", 3);
+
+    std::string extra = envString("SKIN_WARM_QUERIES", "");
+    size_t pos = 0;
+    while (pos <= extra.size()) {
+        size_t comma = extra.find(',', pos);
+        if (comma == std::string::npos) comma = extra.size();
+        std::string q = extra.substr(pos, comma - pos);
+        q.erase(0, q.find_first_not_of(' '));
+        q.erase(q.find_last_not_of(' ') + 1);
+        if (!q.empty()) warmer.pin(q, 10);
+        pos = comma + 1;
+    }
+}
@@ -0,0 +1,422 @@
+#include "steam_parser.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Maximum nesting skipValue() will follow; Steam responses use about 4.
+constexpr int MAX_SKIP_DEPTH = 64;
+
+// Pull scanner over a search response. Reads only the fields a Skin needs
+// and skips everything else without materialising it:
+//
+//   {"results": [ {"name": ..., "sell_price": ..., "asset_description":
+//                  {"icon_url": ..., ...}, ...}, ... ], ...}
+//
+// Any structural error fails the whole page, like a DOM parse would.
+// Skipped strings are only checked for termination, so escapes and UTF-8
+// are validated in the fields we keep, not in the ones we throw away.
+class SearchPageScanner {
+public:
+    SearchPageScanner(const std::string& raw, std::vector<Skin>& out)
+        : p_(raw.data()), end_(raw.data() + raw.size()), out_(out) {}
+
+    bool        sawResults() const { return sawResults_; }
+    const char* error() const      { return error_; }
+
+    bool parse() {
+        ws();
+        if (!expect('{')) return false;
+        if (!members([&]() {
+                if (key_ == "results" && peek() == '[') {
+                    sawResults_ = true;
+                    return results();
+                }
+                return skipValue(0);
+            }))
+            return false;
+        ws();
+        return p_ == end_ || fail("trailing characters");
+    }
+
+private:
+    struct Pending {
+        std::string name, hashName, priceText, salePriceText, icon;
+        double      price    = 0;
+        double      listings = 0;
+        bool        hasName = false, hasHash = false, hasPrice = false, hasListings = false,
+                    hasPriceText = false, hasDesc = false, hasIcon = false;
+    };
+
+    bool fail(const char* why) {
+        if (!error_) error_ = why;
+        return false;
+    }
+
+    void ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) p_++;
+    }
+
+    char peek() {
+        ws();
+        return p_ < end_ ? *p_ : '\0';
+    }
+
+    bool expect(char c) {
+        ws();
+        if (p_ < end_ && *p_ == c) {
+            p_++;
+            return true;
+        }
+        return fail("unexpected character");
+    }
+
+    // Calls `onValue` for each member of an object, with the name in key_.
+    // The opening '{' has already been consumed.
+    template <typename F>
+    bool members(F onValue) {
+        if (peek() == '}') {
+            p_++;
+            return true;
+        }
+        for (;;) {
+            ws();
+            if (!readString(key_) || !expect(':')) return false;
+            ws();
+            if (!onValue()) return false;
+            if (peek() == ',') {
+                p_++;
+                continue;
+            }
+            return expect('}');
+        }
+    }
+
+    bool results() {
+        p_++;   // '['
+        if (peek() == ']') {
+            p_++;
+            return true;
+        }
+        for (;;) {
+            if (peek() == '{') {
+                if (!item()) return false;
+            } else if (!skipValue(0)) {
+                return false;
+            }
+            if (peek() == ',') {
+                p_++;
+                continue;
+            }
+            return expect(']');
+        }
+    }
+
+    bool item() {
+        p_++;   // '{'
+        Pending& it = item_;
+        it.salePriceText.clear();
+        it.hasName = it.hasHash = it.hasPrice = it.hasListings = false;
+        it.hasPriceText = it.hasDesc = it.hasIcon = false;
+
+        bool ok = members([&]() {
+            const std::string& k = key_;
+            if (k == "name")            return stringField(it.name, it.hasName);
+            if (k == "hash_name")       return stringField(it.hashName, it.hasHash);
+            if (k == "sell_price_text") return stringField(it.priceText, it.hasPriceText);
+            if (k == "sale_price_text") {
+                bool unused;
+                return stringField(it.salePriceText, unused);
+            }
+            if (k == "sell_price")      return numberField(it.price, it.hasPrice);
+            if (k == "sell_listings")   return numberField(it.listings, it.hasListings);
+            if (k == "asset_description" && peek() == '{') {
+                p_++;
+                it.hasDesc = true;
+                return members([&]() {
+                    if (key_ == "icon_url") return stringField(it.icon, it.hasIcon);
+                    return skipValue(1);
+                });
+            }
+            return skipValue(0);
+        });
+        if (!ok) return false;
+
+        const double INT_LIMIT = std::numeric_limits<int>::max();
+        if (it.hasName && it.hasHash && it.hasPrice && it.hasListings && it.hasPriceText &&
+            it.hasDesc && it.hasIcon && it.price >= 1 && it.price <= INT_LIMIT &&
+            std::fabs(it.listings) <= INT_LIMIT) {
+            out_.push_back({
+                intern(it.name),
+                intern(it.hashName),
+                intern(it.priceText),
+                intern(it.salePriceText),
+                intern(it.icon),
+                static_cast<int>(it.price),
+                static_cast<int>(it.listings)
+            });
+            parseItemAttributes(out_.back());
+        }
+        return true;
+    }
+
+    bool stringField(std::string& out, bool& has) {
+        if (peek() != '"') return skipValue(0);
+        has = true;
+        return readString(out);
+    }
+
+    bool numberField(double& out, bool& has) {
+        char c = peek();
+        if (c != '-' && (c < '0' || c > '9')) return skipValue(0);
+        has = true;
+        return readNumber(out);
+    }
+
+    static int hex(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool readHex4(unsigned& cp) {
+        if (end_ - p_ < 4) return fail("truncated escape");
+        cp = 0;
+        for (int i = 0; i < 4; i++) {
+            int h = hex(*p_++);
+            if (h < 0) return fail("bad escape");
+            cp = cp << 4 | static_cast<unsigned>(h);
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, unsigned cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | cp >> 6);
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | cp >> 12);
+            out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | cp >> 18);
+            out += static_cast<char>(0x80 | (cp >> 12 & 0x3F));
+            out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // Reads a string at p_ into `out`, reusing its capacity.
+    bool readString(std::string& out) {
+        if (p_ >= end_ || *p_ != '"') return fail("expected string");
+        p_++;
+        out.clear();
+
+        for (;;) {
+            const char* run = p_;
+            while (p_ < end_ && *p_ != '"' && *p_ != '\\') {
+                if (static_cast<unsigned char>(*p_) < 0x20) return fail("control character in string");
+                p_++;
+            }
+            out.append(run, p_);
+            if (p_ >= end_) return fail("unterminated string");
+            if (*p_++ == '"') return true;
+
+            if (p_ >= end_) return fail("unterminated string");
+            switch (*p_++) {
+            case '"':  out += '"';  break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/';  break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                unsigned cp;
+                if (!readHex4(cp)) return false;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    unsigned lo;
+                    if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') return fail("lone surrogate");
+                    p_ += 2;
+                    if (!readHex4(lo)) return false;
+                    if (lo < 0xDC00 || lo > 0xDFFF) return fail("lone surrogate");
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    return fail("lone surrogate");
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default:
+                return fail("bad escape");
+            }
+        }
+    }
+
+    bool skipString() {
+        p_++;   // '"'
+        while (p_ < end_) {
+            char c = *p_++;
+            if (c == '"') return true;
+            if (c == '\\') {
+                if (p_ >= end_) break;
+                p_++;
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    // Integers are accumulated directly; fractions and exponents are
+    // validated and folded in without locale-dependent strtod().
+    bool readNumber(double& out) {
+        bool neg = p_ < end_ && *p_ == '-';
+        if (neg) p_++;
+        if (p_ >= end_ || *p_ < '0' || *p_ > '9') return fail("bad number");
+
+        double v = 0;
+        if (*p_ == '0') {
+            p_++;
+            if (p_ < end_ && *p_ >= '0' && *p_ <= '9') return fail("leading zero");
+        }
+        while (p_ < end_ && *p_ >= '0' && *p_ <= '9') v = v * 10 + (*p_++ - '0');
+
+        if (p_ < end_ && *p_ == '.') {
+            p_++;
+            if (p_ >= end_ || *p_ < '0' || *p_ > '9') return fail("bad number");
+            double scale = 0.1;
+            while (p_ < end_ && *p_ >= '0' && *p_ <= '9') {
+                v += (*p_++ - '0') * scale;
+                scale *= 0.1;
+            }
+        }
+        if (p_ < end_ && (*p_ == 'e' || *p_ == 'E')) {
+            p_++;
+            bool eneg = p_ < end_ && *p_ == '-';
+            if (p_ < end_ && (*p_ == '+' || *p_ == '-')) p_++;
+            if (p_ >= end_ || *p_ < '0' || *p_ > '9') return fail("bad number");
+            int e = 0;
+            while (p_ < end_ && *p_ >= '0' && *p_ <= '9') e = std::min(e * 10 + (*p_++ - '0'), 400);
+            v *= std::pow(10.0, eneg ? -e : e);
+        }
+
+        out = neg ? -v : v;
+        return true;
+    }
+
+    bool literal(const char* word, size_t len) {
+        if (static_cast<size_t>(end_ - p_) < len || std::memcmp(p_, word, len) != 0)
+            return fail("bad literal");
+        p_ += len;
+        return true;
+    }
+
+    bool skipValue(int depth) {
+        if (depth > MAX_SKIP_DEPTH) return fail("nesting too deep");
+        switch (peek()) {
+        case '"': return skipString();
+        case '{':
+            p_++;
+            return members([&]() { return skipValue(depth + 1); });
+        case '[':
+            p_++;
+            if (peek() == ']') {
+                p_++;
+                return true;
+            }
+            for (;;) {
+                if (!skipValue(depth + 1)) return false;
+                if (peek() == ',') {
+                    p_++;
+                    continue;
+                }
+                return expect(']');
+            }
+        case 't': return literal("true", 4);
+        case 'f': return literal("false", 5);
+        case 'n': return literal("null", 4);
+        default: {
+            double unused;
+            return readNumber(unused);
+        }
+        }
+    }
+
+    const char*        p_;
+    const char*        end_;
+    std::vector<Skin>& out_;
+    std::string        key_;
+    Pending            item_;
+    bool               sawResults_ = false;
+    const char*        error_      = nullptr;
+};
+
+} // namespace
+
+std::optional<std::vector<Skin>> parseSearchPage(const std::string& raw, std::string* error) {
+    std::vector<Skin> page;
+    page.reserve(10);
+
+    SearchPageScanner scanner(raw, page);
+    if (!scanner.parse()) {
+        if (error) *error = std::string("JSON parse error: ") + scanner.error();
+        return std::nullopt;
+    }
+    if (!scanner.sawResults()) {
+        if (error) *error = "No results array";
+        return std::nullopt;
+    }
+    return page;
+}
+
+std::optional<std::vector<Skin>> parseSearchPageDom(const std::string& raw, std::string* error) {
+    try {
+        auto data = json::parse(raw);
+
+        if (!data.contains("results") || !data["results"].is_array()) {
+            if (error) *error = "No results array";
+            return std::nullopt;
+        }
+
+        std::vector<Skin> page;
+        for (auto& item : data["results"]) {
+            if (!item.contains("hash_name") || !item.contains("sell_price") ||
+                !item.contains("sell_listings") || !item.contains("name") ||
+                !item.contains("sell_price_text") || !item.contains("asset_description"))
+                continue;
+
+            int price    = item["sell_price"].get<int>();
+            int listings = item["sell_listings"].get<int>();
+            if (price <= 0) continue;
+
+            auto& desc = item["asset_description"];
+            if (!desc.contains("icon_url")) continue;
+
+            page.push_back({
+                intern(item["name"].get<std::string>()),
+                intern(item["hash_name"].get<std::string>()),
+                intern(item["sell_price_text"].get<std::string>()),
+                intern(item.value("sale_price_text", "")),
+                intern(desc["icon_url"].get<std::string>()),
+                price,
+                listings
+            });
+            parseItemAttributes(page.back());
+        }
+        return page;
+
+    } catch (const std::exception& e) {
+        if (error) *error = std::string("JSON parse error: ") + e.what();
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,123 @@
+#include "subset_sum.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+using Word = std::uint64_t;
+
+int highestBit(Word w) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanReverse64(&i, w);
+    return static_cast<int>(i);
+#else
+    return 63 - __builtin_clzll(w);
+#endif
+}
+
+int lowestBit(Word w) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward64(&i, w);
+    return static_cast<int>(i);
+#else
+    return __builtin_ctzll(w);
+#endif
+}
+
+// Largest set bit <= t in a little-endian bitset, or 0 when there is none.
+int highestAtMost(const std::vector<Word>& words, int t) {
+    size_t   i    = static_cast<size_t>(t) / 64;
+    unsigned bits = static_cast<unsigned>(t) % 64;
+    Word     w    = words[i] & (bits == 63 ? ~Word(0) : (Word(2) << bits) - 1);
+    while (!w && i > 0)
+        w = words[--i];
+    return w ? static_cast<int>(i * 64) + highestBit(w) : 0;
+}
+
+// Bitset of reachable totals 0..limit, stored little-endian by word.
+class Reach {
+public:
+    explicit Reach(int limit)
+        : limit_(limit), words_(static_cast<size_t>(limit) / 64 + 1, 0) {
+        words_[0] = 1;  // total 0 is always reachable
+    }
+
+    // this |= this << w, truncated at limit, reporting every total it makes
+    // reachable for the first time, in no particular order. Walking words
+    // high to low keeps the update in place: every word read is at or below
+    // the one written.
+    template <typename OnReached>
+    void addItem(int w, OnReached&& onReached) {
+        const size_t n         = words_.size();
+        const size_t wordShift = static_cast<size_t>(w) / 64;
+        const unsigned bits    = static_cast<unsigned>(w) % 64;
+        if (wordShift >= n) return;
+
+        for (size_t i = n - 1; i >= wordShift; i--) {
+            size_t src = i - wordShift;
+            Word v = words_[src] << bits;
+            if (bits && src > 0)
+                v |= words_[src - 1] >> (64 - bits);
+            if (i == n - 1)
+                v &= topMask();
+            for (Word added = v & ~words_[i]; added; added &= added - 1)
+                onReached(static_cast<int>(i * 64) + lowestBit(added));
+            words_[i] |= v;
+            if (i == wordShift) break;
+        }
+    }
+
+    std::vector<Word> release() { return std::move(words_); }
+
+private:
+    Word topMask() const {
+        unsigned used = static_cast<unsigned>(limit_ % 64) + 1;
+        return used < 64 ? (Word(1) << used) - 1 : ~Word(0);
+    }
+
+    int               limit_;
+    std::vector<Word> words_;
+};
+
+} // namespace
+
+SubsetSumTable::SubsetSumTable(const std::vector<int>& weights, int maxLimit)
+    : weights_(weights) {
+    for (int w : weights_)
+        if (w > 0 && w <= maxLimit) total_ += w;
+    limit_ = static_cast<int>(std::min<long long>(std::max(maxLimit, 0), total_));
+
+    firstItem_.assign(static_cast<size_t>(limit_) + 1, -1);
+    Reach reach(limit_);
+    for (int i = 0; i < static_cast<int>(weights_.size()); i++) {
+        int w = weights_[i];
+        if (w <= 0 || w > limit_) continue;
+        reach.addItem(w, [&](int t) { firstItem_[t] = i; });
+        cells_ += limit_ + 1 - w;
+    }
+    reach_ = reach.release();
+}
+
+int SubsetSumTable::best(int capacity) const {
+    if (capacity <= 0) return 0;
+    return highestAtMost(reach_, std::min(capacity, limit_));
+}
+
+std::vector<int> SubsetSumTable::choose(int capacity) const {
+    std::vector<int> chosen;
+    for (int t = best(capacity); t > 0; t -= weights_[chosen.back()])
+        chosen.push_back(firstItem_[t]);
+    return chosen;
+}
+
+size_t SubsetSumTable::bytes() const {
+    return weights_.size() * sizeof(int) + reach_.size() * sizeof(Word) +
+           firstItem_.size() * sizeof(std::int32_t);
+}
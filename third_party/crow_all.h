@@ -9171,7 +9171,11 @@ namespace crow
                 }
                 if (complete_request_handler_)
                 {
-                    complete_request_handler_();
+                    // For a response ended asynchronously the handler holds the
+                    // connection's last reference and is cleared while it runs;
+                    // the copy keeps the connection (and *this) alive until done.
+                    auto complete = complete_request_handler_;
+                    complete();
                     manual_length_header = false;
                     skip_body = false;
                 }